@@ -0,0 +1,65 @@
+// A batch workload where 100 distinct command lines repeat: parse_args()
+// every time against a ParseCache.
+//
+// usage: cache_bench [rounds=200000]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    OptionsDescription desc;
+    desc.add_options()
+        ("verbose,v", "")
+        ("level", value<int>(), "")
+        ("name", value<std::string>(), "")
+        ("input", value< std::vector<std::string> >()->composing(), "");
+
+    std::vector< std::vector<std::string> > lines(100);
+    std::vector< std::vector<const char*> > argvs(100);
+    for (unsigned i = 0; i < lines.size(); ++i)
+    {
+        lines[i] = {"prog", "-v", "--level=" + std::to_string(i),
+                    "--name=job-" + std::to_string(i), "--input=a.txt",
+                    "--input=b.txt"};
+        for (const auto& t : lines[i])
+            argvs[i].push_back(t.c_str());
+    }
+
+    long checksum = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        const std::vector<const char*>& a = argvs[i % argvs.size()];
+        VariablesMap vm = parse_args(static_cast<int>(a.size()), a.data(), desc);
+        checksum += any_cast<int>(vm["level"].value());
+    }
+    std::chrono::duration<double, std::nano> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("parse_args  %8.1f ns/parse (%ld)\n", d.count() / rounds, checksum);
+
+    ParseCache cache;
+    checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        const std::vector<const char*>& a = argvs[i % argvs.size()];
+        std::shared_ptr<const VariablesMap> vm =
+            cache.parse(static_cast<int>(a.size()), a.data(), desc);
+        checksum += any_cast<int>((*vm)["level"].value());
+    }
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("ParseCache  %8.1f ns/parse (%ld, %lu hits, %lu misses)\n",
+                d.count() / rounds, checksum, cache.hits(), cache.misses());
+    return 0;
+}
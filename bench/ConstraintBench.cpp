@@ -0,0 +1,78 @@
+// Checking a few hundred rules between options after a parse: by hand,
+// with a map lookup per option of each rule as tools usually do it, and
+// with check_constraints(). Every rule holds, so all of them are seen.
+//
+// usage: constraint_bench [options=400] [rounds=20000]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+namespace {
+
+    bool given(const VariablesMap& vm, const std::string& name)
+    {
+        VariablesMap::const_iterator i = vm.find(name);
+        return i != vm.end() && !i->second.isDefaulted();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 400;
+    unsigned rounds = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    OptionsDescription desc;
+    std::vector<std::string> names;
+    for (unsigned i = 0; i < count; ++i)
+        names.push_back("option-" + std::to_string(i));
+    for (unsigned i = 0; i < count; ++i)
+        desc.add_options()(names[i].c_str(), value<int>()->default_value(0), "");
+
+    // Pairs that conflict, and options that need the next one.
+    std::vector< std::pair<std::string, std::string> > conflicts, depends;
+    for (unsigned i = 0; i + 1 < count; i += 2)
+        conflicts.push_back(std::make_pair(names[i], names[i + 1]));
+    for (unsigned i = 0; i + 2 < count; i += 4)
+        depends.push_back(std::make_pair(names[i], names[i + 2]));
+    for (const auto& c : conflicts)
+        desc.conflicts({c.first, c.second});
+    for (const auto& d : depends)
+        desc.depends(d.first, {d.second});
+
+    std::vector<std::string> args;
+    for (unsigned i = 0; i < 16 && i * 4 + 2 < count; ++i)
+    {
+        args.push_back("--" + names[i * 4] + "=1");
+        args.push_back("--" + names[i * 4 + 2] + "=1");
+    }
+    VariablesMap vm;
+    store(command_line_parser(args).options(desc).run(), vm);
+
+    long broken = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        for (const auto& c : conflicts)
+            broken += given(vm, c.first) && given(vm, c.second);
+        for (const auto& d : depends)
+            broken += given(vm, d.first) && !given(vm, d.second);
+    }
+    std::chrono::duration<double, std::micro> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("by hand            %8.2f us/check (%ld)\n", d.count() / rounds, broken);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+        broken += !try_check_constraints(vm, desc);
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("check_constraints  %8.2f us/check (%ld)\n", d.count() / rounds, broken);
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Cost of applying defaults: a description where half the options have
+// a string or string list default and the rest have none, and a command
+// line that sets a few of them, stored into a fresh map each round.
+//
+// usage: defaults_bench [options=1000] [rounds=5000]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 1000;
+    unsigned rounds = argc > 2 ? std::atoi(argv[2]) : 5000;
+
+    OptionsDescription desc;
+    std::vector<std::string> names;
+    for (unsigned i = 0; i < count; ++i)
+        names.push_back("option-" + std::to_string(i));
+    const std::vector<std::string> list(4, "/usr/local/share/some/default/path");
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (i % 2)
+            desc.add_options()(names[i].c_str(), value<std::string>(), "");
+        else if (i % 4)
+            desc.add_options()(names[i].c_str(),
+                value<std::string>()->default_value("a default long enough to allocate"), "");
+        else
+            desc.add_options()(names[i].c_str(),
+                value< std::vector<std::string> >()->default_value(list, ""), "");
+    }
+
+    std::vector<std::string> args;
+    for (unsigned i = 0; i < 4; ++i)
+        args.push_back("--" + names[i * 7 % count] + "=x");
+    ParsedOptions cmdline = command_line_parser(args).options(desc).run();
+
+    std::size_t checksum = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        VariablesMap vm;
+        store(cmdline, vm);
+        checksum += vm.size();
+    }
+    std::chrono::duration<double, std::micro> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("store  %8.2f us/map (%zu)\n", d.count() / rounds, checksum);
+    return 0;
+}
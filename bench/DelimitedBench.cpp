@@ -0,0 +1,103 @@
+// 100k integers given as one delimited token against the same integers
+// given as one multitoken token each, both end to end (parse + store)
+// and for the value conversion alone.
+//
+// usage: delimited_bench [count=100000] [rounds=20]
+
+#include "ProgramOptions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+namespace {
+
+    template<class F>
+    double best_of(unsigned rounds, F f)
+    {
+        double best = 1e30;
+        for (unsigned r = 0; r < rounds; ++r)
+        {
+            std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            f();
+            std::chrono::duration<double, std::milli> d =
+                std::chrono::steady_clock::now() - start;
+            best = (std::min)(best, d.count());
+        }
+        return best;
+    }
+
+    std::size_t stored_size(const VariablesMap& vm)
+    {
+        return any_cast< std::vector<int> >(vm["ids"].value()).size();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    unsigned rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::vector<std::string> tokens;
+    std::string list;
+    unsigned x = 12345;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        x = x * 1103515245u + 12345u;
+        std::string n = std::to_string(x % 1000000);
+        tokens.push_back(n);
+        list += (i ? "," : "") + n;
+    }
+
+    OptionsDescription multitoken;
+    multitoken.add_options()("ids", value< std::vector<int> >()->multitoken(), "");
+    OptionsDescription delimited;
+    delimited.add_options()("ids", value< std::vector<int> >()->delimiter(','), "");
+
+    std::vector<std::string> multitoken_args(1, "--ids");
+    multitoken_args.insert(multitoken_args.end(), tokens.begin(), tokens.end());
+    std::vector<std::string> delimited_args(1, "--ids=" + list);
+
+    std::size_t check = 0;
+    double m_store = best_of(rounds, [&] {
+        VariablesMap vm;
+        store(Basic_command_line_parser(multitoken_args).options(multitoken).run(), vm);
+        check += stored_size(vm);
+    });
+    double d_store = best_of(rounds, [&] {
+        VariablesMap vm;
+        store(Basic_command_line_parser(delimited_args).options(delimited).run(), vm);
+        check += stored_size(vm);
+    });
+
+    std::vector<std::string> one(1, list);
+    double m_convert = best_of(rounds, [&] {
+        Any a;
+        multitoken.options()[0]->semantic()->parse(a, tokens);
+        check += any_cast< std::vector<int> >(a).size();
+    });
+    double d_convert = best_of(rounds, [&] {
+        Any a;
+        delimited.options()[0]->semantic()->parse(a, one);
+        check += any_cast< std::vector<int> >(a).size();
+    });
+
+    if (check != 4ull * rounds * count)
+    {
+        std::printf("unexpected result size\n");
+        return 1;
+    }
+
+    std::printf("%u integers, best of %u\n", count, rounds);
+    std::printf("parse+store  multitoken: %9.3f ms  delimited: %9.3f ms\n",
+                m_store, d_store);
+    std::printf("convert only multitoken: %9.3f ms  delimited: %9.3f ms\n",
+                m_convert, d_convert);
+    return 0;
+}
@@ -0,0 +1,68 @@
+// An error-heavy workload: every other command line has an ambiguous
+// abbreviation or an invalid value. parse_args() with try/catch
+// against try_parse_args().
+//
+// usage: error_bench [rounds=200000]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace options;
+
+namespace {
+
+    template<class F>
+    void run(const char* label, unsigned rounds, F f)
+    {
+        unsigned errors = 0;
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < rounds; ++i)
+            errors += f(i);
+        std::chrono::duration<double, std::nano> d =
+            std::chrono::steady_clock::now() - start;
+        std::printf("%-16s %8.1f ns/parse (%u errors)\n",
+                    label, d.count() / rounds, errors);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    OptionsDescription desc;
+    desc.add_options()
+        ("filter", value<std::string>(), "")
+        ("files", value<std::string>(), "")
+        ("level", value<int>(), "")
+        ("verbose,v", "");
+
+    const char* good[] = {"", "-v", "--filter=x", "--level=3"};
+    const char* ambiguous[] = {"", "-v", "--fil=x", "--level=3"};
+    const char* invalid[] = {"", "-v", "--filter=x", "--level=abc"};
+    const char* const* inputs[] = {good, ambiguous, good, invalid};
+
+    run("exceptions", rounds, [&](unsigned i) {
+        const char* const* args = inputs[i % 4];
+        try {
+            VariablesMap vm = parse_args(4, args, desc);
+            // parse_args() skips invalid values; find them the way a
+            // caller without try_parse_args would have to.
+            if (vm.count("level") && vm["level"].empty())
+                throw std::invalid_argument("level");
+            return 0;
+        } catch (const std::exception&) {
+            return 1;
+        }
+    });
+
+    run("try_parse_args", rounds, [&](unsigned i) {
+        return try_parse_args(4, inputs[i % 4], desc) ? 0 : 1;
+    });
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// parse_config_file() on a site config spread over many fragments: a
+// main file including conf.d/*.json, each fragment setting a few
+// options, loaded on one thread and then on all of them. Also prints
+// the slowest files as reported to the ParseObserver.
+//
+// usage: include_bench [fragments=400] [members=200] [rounds=5]
+
+#include "ProgramOptions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace options;
+
+namespace {
+    struct timing_observer : ParseObserver
+    {
+        void file_loaded(const std::string& path, time_point start, time_point end)
+        {
+            std::chrono::duration<double, std::micro> d = end - start;
+            files.push_back(std::make_pair(d.count(), path));
+        }
+
+        std::vector<std::pair<double, std::string> > files;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    unsigned fragments = argc > 1 ? std::atoi(argv[1]) : 400;
+    unsigned members = argc > 2 ? std::atoi(argv[2]) : 200;
+    unsigned rounds = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    OptionsDescription desc;
+    desc.add_options()
+        ("hosts", value< std::vector<std::string> >()->composing(), "")
+        ("port", value<int>(), "");
+
+    char name[] = "/tmp/include_benchXXXXXX";
+    std::string dir = mkdtemp(name);
+    mkdir((dir + "/conf.d").c_str(), 0700);
+    std::vector<std::string> written;
+    for (unsigned f = 0; f < fragments; ++f)
+    {
+        char file[64];
+        std::snprintf(file, sizeof(file), "/conf.d/%05u.json", f);
+        written.push_back(dir + file);
+        std::ofstream out(written.back().c_str());
+        out << "{\"port\": " << f << ", \"hosts\": [";
+        for (unsigned m = 0; m < members; ++m)
+            out << (m ? ", " : "") << "\"host-" << f << "-" << m << ".example.org\"";
+        out << "]}";
+    }
+    written.push_back(dir + "/main.json");
+    std::ofstream(written.back().c_str()) << "{\"include\": \"conf.d/*.json\"}";
+
+    long checksum = 0;
+    unsigned threads[] = {1, 0};
+    for (unsigned t : threads)
+    {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < rounds; ++i)
+        {
+            VariablesMap vm;
+            store(parse_config_file(written.back(), desc, t), vm);
+            checksum += any_cast<int>(vm["port"].value());
+        }
+        std::chrono::duration<double, std::milli> d =
+            std::chrono::steady_clock::now() - start;
+        std::printf("threads=%-3u %8.2f ms/load (%u files, %ld)\n",
+                    t, d.count() / rounds, fragments + 1, checksum);
+    }
+
+    timing_observer observer;
+    set_parse_observer(&observer);
+    parse_config_file(written.back(), desc);
+    set_parse_observer(0);
+    std::sort(observer.files.rbegin(), observer.files.rend());
+    for (std::size_t i = 0; i < observer.files.size() && i < 3; ++i)
+        std::printf("  %8.1f us  %s\n", observer.files[i].first,
+                    observer.files[i].second.c_str());
+
+    for (const auto& f : written)
+        std::remove(f.c_str());
+    rmdir((dir + "/conf.d").c_str());
+    rmdir(dir.c_str());
+    return 0;
+}
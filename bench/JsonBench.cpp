@@ -0,0 +1,89 @@
+// Streams a generated JSON config of about 10 MB through
+// parse_json_config() and store(): throughput, and the peak of live
+// heap bytes on top of the input text.
+//
+// usage: json_bench [services=60000]
+
+#include "ProgramOptions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+namespace {
+    std::size_t live_bytes = 0;
+    std::size_t peak_bytes = 0;
+
+    // Every block carries its size in front, for the live count.
+    const std::size_t header = 16;
+}
+
+void* operator new(std::size_t n)
+{
+    char* p = static_cast<char*>(std::malloc(n + header));
+    if (!p)
+        throw std::bad_alloc();
+    *reinterpret_cast<std::size_t*>(p) = n;
+    live_bytes += n;
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    return p + header;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+    char* block = static_cast<char*>(p) - header;
+    live_bytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned services = argc > 1 ? std::atoi(argv[1]) : 60000;
+
+    std::string text = "{\"log\": {\"level\": \"debug\"}, \"services\": [";
+    for (unsigned i = 0; i < services; ++i)
+    {
+        std::string n = std::to_string(i);
+        text += (i ? ", " : "");
+        text += "{\"name\": \"service-" + n + "\", \"port\": " +
+            std::to_string(8000 + i % 1000) + ", \"tags\": [\"a\", \"b\"], "
+            "\"env\": {\"HOME\": \"/srv/" + n + "\", \"PATH\": "
+            "\"/usr/local/bin:/usr/bin:/bin\"}, \"replicas\": 3, "
+            "\"description\": \"generated service number " + n + "\"}";
+    }
+    text += "]}";
+
+    OptionsDescription desc;
+    desc.add_options()
+        ("log.level", value<std::string>(), "")
+        ("services.port", value< std::vector<int> >()->composing(), "");
+
+    std::istringstream is(text);
+    const std::size_t base = live_bytes;
+    peak_bytes = base;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    VariablesMap vm;
+    store(parse_json_config(is, desc), vm);
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+
+    std::printf("json %.1f MB  %7.1f MB/s  peak %.2f MB over the input (%zu ports)\n",
+                text.size() / 1e6, text.size() / 1e6 / d.count(),
+                (peak_bytes - base) / 1e6,
+                any_cast< std::vector<int> >(vm["services.port"].value()).size());
+    return 0;
+}
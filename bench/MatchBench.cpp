@@ -0,0 +1,127 @@
+// Option name lookups through OptionsDescription::find_nothrow, case
+// sensitive and case insensitive, against a copy of the previous
+// matcher that lower-cased both sides into temporary strings. Heap
+// allocations are counted through a replaced global operator new.
+//
+// usage: match_bench [options=200] [lookups=200000]
+
+#include "ProgramOptions.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+    std::atomic<unsigned long> allocations(0);
+}
+
+void* operator new(std::size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using namespace options;
+
+namespace {
+
+    std::string lower(const std::string& s)
+    {
+        std::string result;
+        for (std::string::size_type i = 0; i < s.size(); ++i)
+            result.append(1, static_cast<char>(std::tolower(s[i])));
+        return result;
+    }
+
+    // The matcher as it was: both names lowered into fresh strings and
+    // every match recorded by key.
+    const OptionDescription* previous_find(const OptionsDescription& desc,
+                                           const std::string& name)
+    {
+        const OptionDescription* found = 0;
+        std::vector<std::string> full;
+        std::vector<std::string> approximate;
+        for (const auto& d : desc.options())
+        {
+            std::string long_name = lower(d->long_name());
+            std::string option = lower(name);
+            if (long_name == option)
+            {
+                full.push_back(d->key(name));
+                found = d.get();
+            }
+            else if (long_name.find(option) == 0)
+            {
+                approximate.push_back(d->key(name));
+                if (full.empty())
+                    found = d.get();
+            }
+        }
+        return found;
+    }
+
+    template<class F>
+    void run(const char* label, const std::vector<std::string>& names,
+             unsigned lookups, F f)
+    {
+        unsigned hits = 0;
+        unsigned long before = allocations.load();
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < lookups; ++i)
+            hits += f(names[i % names.size()]) != 0;
+        std::chrono::duration<double, std::nano> d =
+            std::chrono::steady_clock::now() - start;
+        unsigned long allocated = allocations.load() - before;
+        std::printf("%-28s %8.1f ns/lookup %8.2f allocs/lookup (%u hits)\n",
+                    label, d.count() / lookups,
+                    double(allocated) / lookups, hits);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 200;
+    unsigned lookups = argc > 2 ? std::atoi(argv[2]) : 200000;
+
+    OptionsDescription desc;
+    std::vector<std::string> exact, shouted;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        std::string name = "option-number-" + std::to_string(i);
+        desc.add_options()(name.c_str(), value<int>(), "");
+        exact.push_back(name);
+        shouted.push_back("Option-NUMBER-" + std::to_string(i));
+    }
+
+    run("find_nothrow", exact, lookups,
+        [&](const std::string& n) {
+            return desc.find_nothrow(n, false, false, false);
+        });
+    run("find_nothrow ignore case", shouted, lookups,
+        [&](const std::string& n) {
+            return desc.find_nothrow(n, false, true, true);
+        });
+    run("previous ignore case", shouted, lookups,
+        [&](const std::string& n) {
+            return previous_find(desc, n);
+        });
+    return 0;
+}
@@ -0,0 +1,58 @@
+// store() against store_parallel() on one large parse: a multitoken
+// list of ints, a composing list of doubles given once per value and a
+// few scalars, stored into a fresh map each round.
+//
+// usage: parallel_store_bench [values=500000] [threads=0] [rounds=10]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned values = argc > 1 ? std::atoi(argv[1]) : 500000;
+    unsigned threads = argc > 2 ? std::atoi(argv[2]) : 0;
+    unsigned rounds = argc > 3 ? std::atoi(argv[3]) : 10;
+
+    OptionsDescription desc;
+    desc.add_options()
+        ("ids", value< std::vector<int> >()->multitoken(), "")
+        ("ratio", value< std::vector<double> >()->composing(), "")
+        ("level", value<int>(), "")
+        ("name", value<std::string>(), "");
+
+    std::vector<std::string> args = {"--level=3", "--name=bench", "--ids"};
+    for (unsigned i = 0; i < values / 2; ++i)
+        args.push_back(std::to_string(i * 7919 % 1000003));
+    for (unsigned i = 0; i < values - values / 2; ++i)
+        args.push_back("--ratio=" + std::to_string(i % 1000) + ".25");
+    ParsedOptions parsed = command_line_parser(args).options(desc).run();
+
+    long checksum = 0;
+    for (int parallel = 0; parallel < 2; ++parallel)
+    {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < rounds; ++i)
+        {
+            VariablesMap vm;
+            if (parallel)
+                store_parallel(parsed, vm, threads);
+            else
+                store(parsed, vm);
+            checksum += any_cast< std::vector<int> >(vm["ids"].value()).size();
+        }
+        std::chrono::duration<double, std::nano> d =
+            std::chrono::steady_clock::now() - start;
+        std::printf("%-14s %8.1f ns/value (%u values, %ld)\n",
+                    parallel ? "store_parallel" : "store",
+                    d.count() / rounds / values, values, checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Registers many options and looks them up: heap allocations and bytes
+// per registered option, then find_nothrow time for exact names, without
+// and with abbreviations allowed.
+//
+// usage: register_bench [options=10000] [lookups=100000]
+
+#include "ProgramOptions.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+    std::atomic<unsigned long> allocations(0);
+    std::atomic<unsigned long> allocated_bytes(0);
+}
+
+void* operator new(std::size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    unsigned lookups = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+    std::vector<std::string> names;
+    for (unsigned i = 0; i < count; ++i)
+        names.push_back("option-" + std::to_string(i * 7919 % 100000));
+
+    unsigned long a = allocations.load(), b = allocated_bytes.load();
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    OptionsDescription desc;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (i % 2)
+            desc.add_options()(names[i].c_str(), "a flag option");
+        else
+            desc.add_options()(names[i].c_str(), value<int>(), "an int option");
+    }
+    std::chrono::duration<double, std::nano> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("register %u options  %8.1f ns/option %6.2f allocs/option %7.1f bytes/option\n",
+                count, d.count() / count,
+                double(allocations.load() - a) / count,
+                double(allocated_bytes.load() - b) / count);
+
+    unsigned hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < lookups; ++i)
+        hits += desc.find_nothrow(names[i * 31 % count], false) != 0;
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("find_nothrow          %8.1f ns/lookup (%u hits)\n",
+                d.count() / lookups, hits);
+
+    // Allowing abbreviations goes through the sorted names instead.
+    hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < lookups; ++i)
+        hits += desc.find_nothrow(names[i * 31 % count], true) != 0;
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("find_nothrow approx   %8.1f ns/lookup (%u hits)\n",
+                d.count() / lookups, hits);
+    return 0;
+}
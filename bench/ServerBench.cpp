@@ -0,0 +1,112 @@
+// Command lines read from a file descriptor: CommandServer against
+// building the description and parsing from scratch for every line,
+// as a process per command would.
+//
+// usage: server_bench [lines=100000]
+
+#include "ProgramOptions.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    std::atomic<unsigned long> allocations(0);
+
+    void describe(options::OptionsDescription& desc)
+    {
+        using namespace options;
+        desc.add_options()
+            ("verbose,v", "")
+            ("quiet,q", "")
+            ("level", value<int>(), "")
+            ("name", value<std::string>(), "")
+            ("input", value< std::vector<std::string> >()->composing(), "");
+        for (int i = 0; i < 20; ++i)
+            desc.add_options()(("extra-" + std::to_string(i)).c_str(),
+                               value<std::string>(), "");
+    }
+}
+
+void* operator new(std::size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    std::vector<std::string> lines;
+    std::string text;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        lines.push_back("-v --level=" + std::to_string(i % 10) +
+                        " --name='job " + std::to_string(i) +
+                        "' --input=a.txt --input=b.txt");
+        text += lines.back() + "\n";
+    }
+
+    char path[] = "/tmp/server_benchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, text.data(), text.size()) != (ssize_t)text.size())
+        return 1;
+    unlink(path);
+
+    unsigned long checksum = 0;
+    unsigned long a = allocations.load();
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < count; ++i)
+    {
+        OptionsDescription desc;
+        describe(desc);
+        std::vector<std::string> tokens = split_unix(lines[i]);
+        VariablesMap vm;
+        store(command_line_parser(tokens).options(desc).run(), vm);
+        checksum += any_cast<int>(vm["level"].value());
+    }
+    std::chrono::duration<double, std::nano> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("setup per line  %8.1f ns/line %7.1f allocs/line (%lu)\n",
+                d.count() / count, double(allocations.load() - a) / count,
+                checksum);
+
+    OptionsDescription desc;
+    describe(desc);
+    CommandServer server(desc);
+    checksum = 0;
+    lseek(fd, 0, SEEK_SET);
+    a = allocations.load();
+    start = std::chrono::steady_clock::now();
+    server.serve(fd, [&](const VariablesMap& vm, const Parse_error&) {
+        checksum += any_cast<int>(vm["level"].value());
+        return true;
+    });
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("CommandServer   %8.1f ns/line %7.1f allocs/line (%lu)\n",
+                d.count() / count, double(allocations.load() - a) / count,
+                checksum);
+    close(fd);
+    return 0;
+}
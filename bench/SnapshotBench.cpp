@@ -0,0 +1,119 @@
+// Readers looking up options while a control thread keeps reloading the
+// configuration: a mutex around a shared VariablesMap against
+// VariablesMapPublisher snapshots.
+//
+// usage: snapshot_bench [readers=64] [milliseconds=1000]
+
+#include "ProgramOptions.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace options;
+
+namespace {
+
+    const int option_count = 64;
+
+    OptionsDescription make_description()
+    {
+        OptionsDescription desc;
+        for (int i = 0; i < option_count; ++i)
+            desc.add_options()(("option" + std::to_string(i)).c_str(), "");
+        return desc;
+    }
+
+    VariablesMap make_config(const OptionsDescription& desc, int generation)
+    {
+        std::vector<std::string> args;
+        for (int i = 0; i < option_count; ++i)
+            args.push_back("--option" + std::to_string(i) + "=" +
+                           std::to_string(generation));
+        VariablesMap vm;
+        store(Basic_command_line_parser(args).options(desc).run(), vm);
+        return vm;
+    }
+
+    template<class Reader, class Writer>
+    double run(unsigned readers, unsigned ms, Reader read, Writer write)
+    {
+        std::atomic<bool> stop(false);
+        std::atomic<unsigned long long> total(0);
+        std::vector<std::thread> threads;
+
+        for (unsigned r = 0; r < readers; ++r)
+            threads.emplace_back([&, r] {
+                unsigned long long n = 0;
+                std::vector<std::string> keys;
+                for (int i = 0; i < option_count; ++i)
+                    keys.push_back("option" + std::to_string(i));
+                while (!stop.load(std::memory_order_relaxed))
+                    n += read(r, keys[n % option_count]);
+                total += n;
+            });
+
+        std::thread writer([&] {
+            int generation = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                write(++generation);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        stop = true;
+        for (auto& t : threads)
+            t.join();
+        writer.join();
+        return total.load() * 1000.0 / ms;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned readers = argc > 1 ? std::atoi(argv[1]) : 64;
+    unsigned ms = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    OptionsDescription desc = make_description();
+
+    {
+        std::mutex lock;
+        VariablesMap shared = make_config(desc, 0);
+        double rate = run(readers, ms,
+            [&](unsigned, const std::string& key) {
+                std::lock_guard<std::mutex> guard(lock);
+                return shared[key].empty() ? 0 : 1;
+            },
+            [&](int generation) {
+                VariablesMap next = make_config(desc, generation);
+                std::lock_guard<std::mutex> guard(lock);
+                shared = next;
+            });
+        std::printf("mutex      %3u readers: %12.0f reads/s\n", readers, rate);
+    }
+
+    {
+        VariablesMapPublisher publisher(readers);
+        publisher.publish(make_config(desc, 0));
+        std::vector<VariablesMapPublisher::Subscriber> subscribers;
+        for (unsigned r = 0; r < readers; ++r)
+            subscribers.push_back(publisher.subscribe());
+        double rate = run(readers, ms,
+            [&](unsigned r, const std::string& key) {
+                VariablesMapPublisher::Snapshot s = subscribers[r].read();
+                return (*s)[key].empty() ? 0 : 1;
+            },
+            [&](int generation) {
+                publisher.publish(make_config(desc, generation));
+            });
+        std::printf("publisher  %3u readers: %12.0f reads/s\n", readers, rate);
+    }
+    return 0;
+}
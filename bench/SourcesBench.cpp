@@ -0,0 +1,70 @@
+// A command line, the environment and two config files stored into one
+// map: as a chain of store() calls, and with store_sources(). The
+// description has many options with defaults, and each source sets only
+// a few of them.
+//
+// usage: sources_bench [options=500] [rounds=20000]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned count = argc > 1 ? std::atoi(argv[1]) : 500;
+    unsigned rounds = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    OptionsDescription desc;
+    std::vector<std::string> names;
+    for (unsigned i = 0; i < count; ++i)
+        names.push_back("option-" + std::to_string(i));
+    for (unsigned i = 0; i < count; ++i)
+        desc.add_options()(names[i].c_str(), value<int>()->default_value(i), "");
+
+    std::vector<std::string> args;
+    for (unsigned i = 0; i < 4; ++i)
+        args.push_back("--" + names[i * 7 % count] + "=" + std::to_string(i));
+    ParsedOptions cmdline = command_line_parser(args).options(desc).run();
+
+    setenv("SOURCES_BENCH_OPTION-1", "11", 1);
+    ParsedOptions env = parse_environment(desc, "SOURCES_BENCH_");
+
+    std::istringstream site("{\"option-2\": 2, \"option-3\": 3}");
+    ParsedOptions site_file = parse_json_config(site, desc);
+    std::istringstream user("{\"option-4\": 4}");
+    ParsedOptions user_file = parse_json_config(user, desc);
+
+    long checksum = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        VariablesMap vm;
+        store(cmdline, vm);
+        store(env, vm);
+        store(site_file, vm);
+        store(user_file, vm);
+        checksum += any_cast<int>(vm["option-1"].value());
+    }
+    std::chrono::duration<double, std::micro> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("store chain    %8.2f us/merge (%ld)\n", d.count() / rounds, checksum);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        VariablesMap vm;
+        store_sources({&cmdline, &env, &site_file, &user_file}, vm);
+        checksum += any_cast<int>(vm["option-1"].value());
+    }
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("store_sources  %8.2f us/merge (%ld)\n", d.count() / rounds, checksum);
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Per-option cost of store() for built-in value types: a command line
+// of ints, doubles, strings, flags and a composing vector, parsed once
+// and stored into a fresh map each round.
+//
+// usage: store_bench [rounds=200000]
+
+#include "ProgramOptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+int main(int argc, char** argv)
+{
+    unsigned rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    OptionsDescription desc;
+    desc.add_options()
+        ("verbose", "")
+        ("level", value<int>(), "")
+        ("jobs", value<unsigned>(), "")
+        ("ratio", value<double>(), "")
+        ("name", value<std::string>(), "")
+        ("input", value< std::vector<std::string> >()->composing(), "")
+        ("id", value< std::vector<int> >()->composing(), "");
+
+    std::vector<std::string> args = {
+        "--verbose", "--level=3", "--jobs=8", "--ratio=0.75", "--name=build",
+        "--input=a.txt", "--input=b.txt", "--id=1", "--id=2", "--id=3",
+        "--level=4", "--name=test"};
+    ParsedOptions parsed = command_line_parser(args).options(desc).run();
+    const std::size_t options = parsed.size();
+
+    long checksum = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+    {
+        VariablesMap vm;
+        store(parsed, vm);
+        checksum += any_cast<int>(vm["level"].value());
+    }
+    std::chrono::duration<double, std::nano> d =
+        std::chrono::steady_clock::now() - start;
+    std::printf("store        %8.1f ns/option (%zu options, %ld)\n",
+                d.count() / rounds / options, options, checksum);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i)
+        checksum += command_line_parser(args).options(desc).run().size();
+    d = std::chrono::steady_clock::now() - start;
+    std::printf("command line %8.1f ns/option (%ld)\n",
+                d.count() / rounds / options, checksum);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "CmdlineFuzz.hpp"
+
+#include "ProgramOptions.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace options;
+
+namespace {
+    std::atomic<unsigned long> allocations(0);
+    std::atomic<unsigned long> allocated_bytes(0);
+    fuzz_work last_work = { 0, 0 };
+}
+
+void* operator new(std::size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+    const OptionsDescription& description()
+    {
+        static OptionsDescription desc = [] {
+            OptionsDescription d("fuzz");
+            d.add_options()
+                ("help,h", "")
+                ("verbose,v", "")
+                ("filter,f", value<std::string>(), "")
+                ("level,l", value<int>(), "")
+                ("list", value< std::vector<int> >()->delimiter(','), "")
+                ("ids,i", value< std::vector<int> >()->multitoken(), "")
+                ("name,n", value<std::string>()->composing(), "");
+            return d;
+        }();
+        return desc;
+    }
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "invariant failed: %s\n", what);
+            std::abort();
+        }
+    }
+
+    // Everything the parser produced, in bytes plus one per entry.
+    std::size_t output_size(const ParsedOptions& parsed)
+    {
+        std::size_t n = 0;
+        for (const auto& opt : parsed.options())
+        {
+            n += 1 + opt.string_key.size();
+            for (const auto& v : opt.value)
+                n += 1 + v.size();
+            for (const auto& t : opt.original_tokens)
+                n += 1 + t.size();
+        }
+        return n;
+    }
+
+    // Counts what the current run allocates, into last_work at the end.
+    struct work_meter
+    {
+        work_meter()
+        : allocations_at(allocations.load()), bytes_at(allocated_bytes.load())
+        {}
+
+        ~work_meter() { last_work = now(); }
+
+        fuzz_work now() const
+        {
+            fuzz_work w = { allocations.load() - allocations_at,
+                            allocated_bytes.load() - bytes_at };
+            return w;
+        }
+
+        unsigned long allocations_at, bytes_at;
+    };
+}
+
+fuzz_work last_fuzz_work()
+{
+    return last_work;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    work_meter meter;
+    const char* p = reinterpret_cast<const char*>(data);
+    TokenBuffer args;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= size; ++i)
+        if (i == size || p[i] == '\0')
+        {
+            args.push_back(p + start, i - start);
+            start = i + 1;
+        }
+
+    const OptionsDescription& desc = description();
+    ParsedOptions parsed(&desc);
+    try {
+        parsed = command_line_parser(args).options(desc).run();
+    } catch (const std::exception&) {
+        // Ambiguous abbreviations are reported by throwing.
+        return 0;
+    }
+
+    // The parser does a bounded amount of work per input byte, so what
+    // it returns is bounded too.
+    check(output_size(parsed) <= 16 * (size + args.size()) + 64,
+          "output grows faster than the input");
+
+    // Original tokens come from the arguments, in order, each once.
+    const std::vector<Basic_option> options = parsed.options();
+    std::size_t next = 0;
+    for (const auto& opt : options)
+        for (const auto& t : opt.original_tokens)
+        {
+            while (next < args.size() &&
+                   t.compare(0, std::string::npos,
+                             args.token(next), args.length(next)) != 0)
+                ++next;
+            check(next < args.size(), "original token not in the input");
+            ++next;
+        }
+
+    int position = 0;
+    for (const auto& opt : options)
+    {
+        if (opt.string_key.empty())
+            check(opt.position_key == position++, "positions out of order");
+        else
+            check(desc.find_nothrow(opt.string_key, true, true, true) != 0,
+                  "parsed option is not in the description");
+    }
+
+    VariablesMap vm;
+    try {
+        store(parsed, vm);
+    } catch (const std::exception&) {
+        return 0;
+    }
+    for (const auto& v : vm)
+        check(desc.find_nothrow(v.first, false, false, false) != 0,
+              "stored variable is not in the description");
+
+    // So is the work done for it, counted without a clock so that the
+    // same input always passes or fails.
+    fuzz_work w = meter.now();
+    check(w.allocations <= 16 * (size + 1) + 256,
+          "allocations grow faster than the input");
+    check(w.bytes <= 1024 * (size + 1) + 16384,
+          "allocated bytes grow faster than the input");
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef CMDLINEFUZZ_H
+#define CMDLINEFUZZ_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Runs one input through Cmdline::run, find_nothrow and store() and
+   aborts when an invariant does not hold, among them a bound on the
+   heap allocations and allocated bytes per input byte. Arguments are
+   separated by NUL bytes. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/* The heap allocations and allocated bytes of the last run of
+   LLVMFuzzerTestOneInput; the same input always gives the same. */
+struct fuzz_work
+{
+    unsigned long allocations;
+    unsigned long bytes;
+};
+
+fuzz_work last_fuzz_work();
+
+#endif
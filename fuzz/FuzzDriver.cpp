@@ -0,0 +1,150 @@
+// Standalone driver for the fuzz target, for builds without libFuzzer.
+//
+//   cmdline_fuzz                 scaling checks, then random inputs
+//   cmdline_fuzz FILE...         run the given inputs
+//
+// The scaling checks feed pathological command lines at two sizes and
+// compare the work per input byte, counted as heap allocations and
+// allocated bytes. A family fails when the per-byte work at the larger
+// size is well above the one at the smaller size. The time is shown
+// alongside but does not fail anything.
+
+#include "CmdlineFuzz.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct work
+    {
+        double allocations;
+        double bytes;
+        double nanoseconds;
+    };
+
+    work measure(const std::string& input)
+    {
+        work best = { 0, 0, 1e300 };
+        for (int round = 0; round < 3; ++round)
+        {
+            std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            LLVMFuzzerTestOneInput(
+                reinterpret_cast<const uint8_t*>(input.data()), input.size());
+            std::chrono::duration<double, std::nano> d =
+                std::chrono::steady_clock::now() - start;
+            fuzz_work w = last_fuzz_work();
+            best.allocations = double(w.allocations);
+            best.bytes = double(w.bytes);
+            best.nanoseconds = std::min(best.nanoseconds, d.count());
+        }
+        return best;
+    }
+
+    // Arguments are NUL separated; 'unit' is repeated up to 'size' bytes.
+    typedef std::string (*family)(std::size_t size);
+
+    std::string repeat(const std::string& head, const std::string& unit,
+                       std::size_t size)
+    {
+        std::string s = head;
+        while (s.size() < size)
+            s += unit;
+        return s;
+    }
+
+    std::string bundle(std::size_t n)      { return repeat("-", "hv", n); }
+    std::string equals(std::size_t n)      { return repeat("-f", "=", n); }
+    std::string long_equals(std::size_t n) { return repeat("--filter", "=", n); }
+    std::string multitoken(std::size_t n)  { return repeat("--ids", std::string("\0" "7", 2), n); }
+    std::string delimited(std::size_t n)   { return repeat("--list=1", ",2", n); }
+    std::string repeated(std::size_t n)    { return repeat("", std::string("--level=3\0", 10), n); }
+    std::string composing(std::size_t n)   { return repeat("", std::string("-nx\0", 4), n); }
+    std::string positional(std::size_t n)  { return repeat("", std::string("p\0", 2), n); }
+    std::string unknown(std::size_t n)     { return repeat("--", "x", n); }
+    std::string bundle_value(std::size_t n){ return repeat("-hf=", "a", n); }
+
+    bool scaling_checks()
+    {
+        struct { const char* name; family make; } families[] = {
+            { "-hvhv...", bundle },
+            { "-f====...", equals },
+            { "--filter====...", long_equals },
+            { "--ids 7 7 7...", multitoken },
+            { "--list=1,2,2...", delimited },
+            { "--level=3 ...", repeated },
+            { "-nx -nx ...", composing },
+            { "p p p ...", positional },
+            { "--xxxx...", unknown },
+            { "-hf=aaaa...", bundle_value },
+        };
+        const std::size_t small = 4096, large = 65536;
+        const double ratio = double(large) / small;
+        bool ok = true;
+
+        std::printf("%-18s %12s %12s %12s\n", "family",
+                    "allocs x", "bytes x", "time x");
+        for (const auto& f : families)
+        {
+            work a = measure(f.make(small));
+            work b = measure(f.make(large));
+            // Growth of the per-byte work from the small to the large input.
+            double allocs = (b.allocations + 1) / (a.allocations + 1) / ratio;
+            double bytes = (b.bytes + 1) / (a.bytes + 1) / ratio;
+            // Time is only reported: it depends on the machine and its load.
+            double time = b.nanoseconds / a.nanoseconds / ratio;
+            bool linear = allocs < 2 && bytes < 2;
+            std::printf("%-18s %12.2f %12.2f %12.2f%s\n", f.name,
+                        allocs, bytes, time, linear ? "" : "  SUPER-LINEAR");
+            ok = ok && linear;
+        }
+        return ok;
+    }
+
+    void random_inputs(unsigned count)
+    {
+        static const char alphabet[] = "-=,hvflinx017 \0\0\0";
+        unsigned long long x = 88172645463325252ULL;
+        std::string input;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            input.resize(x % 256);
+            for (std::size_t j = 0; j < input.size(); ++j)
+            {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                input[j] = alphabet[x % (sizeof(alphabet) - 1)];
+            }
+            // The target checks its own work per byte.
+            LLVMFuzzerTestOneInput(
+                reinterpret_cast<const uint8_t*>(input.data()), input.size());
+        }
+        std::printf("%u random inputs\n", count);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::ifstream in(argv[i], std::ios::binary);
+            std::string input((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(
+                reinterpret_cast<const uint8_t*>(input.data()), input.size());
+        }
+        return 0;
+    }
+
+    bool ok = scaling_checks();
+    random_inputs(20000);
+    return ok ? 0 : 1;
+}
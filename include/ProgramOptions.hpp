@@ -1,11 +1,17 @@
 #ifndef PROGRAM_OPTIONS_
 #define PROGRAM_OPTIONS_
 
+#include "program_options/CommandServer.hpp"
 #include "program_options/Option.hpp"
 #include "program_options/OptionsDescription.hpp"
+#include "program_options/ParseCache.hpp"
+#include "program_options/ParseObserver.hpp"
 #include "program_options/Parsers.hpp"
 #include "program_options/PositionalOptions.hpp"
+#include "program_options/StructDescription.hpp"
 #include "program_options/ValueSemantic.hpp"
 #include "program_options/VariablesMap.hpp"
+#include "program_options/VariablesOverlay.hpp"
+#include "program_options/VariablesMapPublisher.hpp"
 
 #endif
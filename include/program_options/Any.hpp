@@ -2,37 +2,185 @@
 #define ANY_H
 
 #include <sstream>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
 namespace options{
 
+    namespace detail {
+
+        template<class T>
+        struct is_streamable
+        {
+            template<class U>
+            static auto test(int) -> decltype(
+                std::declval<std::ostream&>() << std::declval<const U&>(),
+                std::true_type());
+            template<class>
+            static std::false_type test(...);
+
+            enum { value = decltype(test<T>(0))::value };
+        };
+
+        template<class T>
+        typename std::enable_if<is_streamable<T>::value>::type
+        to_text(std::ostream& os, const T& x)
+        {
+            os << x;
+        }
+
+        template<class T>
+        typename std::enable_if<!is_streamable<T>::value>::type
+        to_text(std::ostream&, const T&)
+        {
+        }
+
+        /* Wide strings are shown as UTF-8. */
+        void to_text(std::ostream& os, const std::wstring& s);
+
+        template<class T>
+        void to_text(std::ostream& os, const std::vector<T>& xs)
+        {
+            for (typename std::vector<T>::size_type i = 0; i < xs.size(); ++i)
+            {
+                if (i)
+                    os << ' ';
+                to_text(os, xs[i]);
+            }
+        }
+    }
+
+    struct bad_any_cast : public std::bad_cast
+    {
+        const char* what() const throw() { return "options::bad_any_cast"; }
+    };
+
     struct Any
     {
         Any()
         {}
 
-        Any(bool)
+        template<typename T>
+        Any(const T& x)
+        : m_content(new holder<T>(x))
         {}
 
-        bool empty() const {return true;}
+        Any(const Any& other)
+        : m_content(other.m_content ? other.m_content->clone() : 0)
+        {}
+
+        Any(Any&& other)
+        : m_content(std::move(other.m_content))
+        {}
+
+        Any& operator=(const Any& other)
+        {
+            Any(other).swap(*this);
+            return *this;
+        }
+
+        Any& operator=(Any&& other)
+        {
+            m_content = std::move(other.m_content);
+            return *this;
+        }
 
         template<typename T>
-        void operator=(T& x)
+        typename std::enable_if<
+            !std::is_same<typename std::decay<T>::type, Any>::value, Any&>::type
+        operator=(T&& x)
+        {
+            m_content.reset(
+                new holder<typename std::decay<T>::type>(std::forward<T>(x)));
+            return *this;
+        }
+
+        void swap(Any& other)
         {
-        	stringstream ss;
-        	ss<<x;
-        	value = ss.str();
+            m_content.swap(other.m_content);
         }
 
+        bool empty() const {return !m_content;}
+
+        const std::type_info& type() const
+        {
+            return m_content ? m_content->type() : typeid(void);
+        }
+
+        /** Textual form of the value, empty if it cannot be streamed. */
         std::string str() const
         {
-        	return value;
+            std::ostringstream ss;
+            if (m_content)
+                m_content->print(ss);
+            return ss.str();
         }
 
     private:
-        std::string value;
+        struct placeholder
+        {
+            virtual ~placeholder() {}
+            virtual const std::type_info& type() const = 0;
+            virtual placeholder* clone() const = 0;
+            virtual void print(std::ostream& os) const = 0;
+        };
+
+        template<typename T>
+        struct holder : public placeholder
+        {
+            holder(const T& x) : held(x) {}
+            holder(T&& x) : held(std::move(x)) {}
+
+            const std::type_info& type() const { return typeid(T); }
+            placeholder* clone() const { return new holder(held); }
+            void print(std::ostream& os) const { detail::to_text(os, held); }
+
+            T held;
+        };
+
+        std::unique_ptr<placeholder> m_content;
+
+        template<typename T>
+        friend T* any_cast(Any* operand);
     };
+
+    template<typename T>
+    T* any_cast(Any* operand)
+    {
+        if (!operand || operand->type() != typeid(T))
+            return 0;
+        return &static_cast<Any::holder<T>*>(operand->m_content.get())->held;
+    }
+
+    template<typename T>
+    const T* any_cast(const Any* operand)
+    {
+        return any_cast<T>(const_cast<Any*>(operand));
+    }
+
+    template<typename T>
+    const T& any_cast(const Any& operand)
+    {
+        const T* result = any_cast<T>(&operand);
+        if (!result)
+            throw bad_any_cast();
+        return *result;
+    }
+
+    template<typename T>
+    T& any_cast(Any& operand)
+    {
+        T* result = any_cast<T>(&operand);
+        if (!result)
+            throw bad_any_cast();
+        return *result;
+    }
 }
 
 #endif /* ANY_H */
@@ -0,0 +1,73 @@
+#ifndef COMMANDSERVER_H
+#define COMMANDSERVER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Errors.hpp"
+#include "Parsers.hpp"
+#include "VariablesMap.hpp"
+
+namespace options {
+
+    /** Parses a stream of command lines against one description, for
+        processes that serve many invocations. Lines end with a newline
+        (a preceding '\r' is dropped) or, for lines that may contain
+        newlines, with a NUL. Each line is split as by split_unix(),
+        parsed, stored into one VariablesMap that is emptied between
+        lines and checked as by check_constraints(). The read buffer,
+        the line, the tokens, the id sets of the map and its entries
+        for options that come back, defaults included, keep their
+        allocations from one line to the next. A line longer than
+        'max_line' bytes is skipped and handed over as an
+        invalid_syntax error with an empty map.
+
+            CommandServer server(desc);
+            server.serve(0, [](const VariablesMap& vm, const Parse_error& e) {
+                ...
+                return true;
+            });
+
+        The map is only valid during the call to the handler, which
+        returns false to stop serving. notify() is left to the handler.
+    */
+    struct CommandServer
+    {
+        typedef std::function<bool(const VariablesMap&, const Parse_error&)>
+            handler;
+
+        explicit CommandServer(const OptionsDescription& desc,
+                               char delimiter = '\n',
+                               std::size_t max_line = 1024 * 1024);
+
+        /** Serves the lines read from 'fd' until end of input or until
+            the handler returns false; returns the number of lines
+            handled. Throws std::system_error if reading fails. */
+        std::size_t serve(int fd, const handler& h);
+
+        /** Parses one line and hands the result to 'h'; returns what
+            'h' returned. */
+        bool serve_line(const char* line, std::size_t size, const handler& h);
+
+    private:
+        // Parses m_line.
+        bool serve_line(const handler& h);
+        // Reports a line longer than m_max_line.
+        bool serve_overlong(const handler& h);
+
+        detail::Cmdline m_cmdline;
+        ParsedOptions m_parsed;
+        VariablesMap m_map;
+        Parse_error m_error;
+
+        std::vector<char> m_buffer;
+        std::string m_line;
+        char m_delimiter;
+        std::size_t m_max_line;
+    };
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef ERRORS_H
+#define ERRORS_H
+
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace options {
+
+    /** What went wrong in a parse, as data. Building one costs nothing
+        until an error actually happens. */
+    struct Parse_error
+    {
+        enum kind_type {
+            none = 0,
+            /** The name is an abbreviation of several options. */
+            ambiguous_option,
+            /** The option's value_semantic rejected its tokens. */
+            invalid_value,
+            /** A config source is malformed; token_index is the byte
+                offset and token says what was expected. */
+            invalid_syntax,
+            /** The config file 'token' cannot be read. */
+            unreadable_file,
+            /** The config file 'token' includes itself, directly or
+                through others. */
+            include_cycle,
+            /** The options in 'candidates' were given together against
+                a conflicts() or one_of() rule; 'option' is the last of
+                them. */
+            conflicting_options,
+            /** 'option' was given without 'token', which it depends()
+                on. */
+            missing_dependency,
+            /** None of the options in 'candidates' was given, against
+                a one_of() or at_least_one() rule. */
+            missing_one_of,
+            /** A rule names 'token', which is not the key of an option
+                of the description. */
+            unknown_rule_option
+        };
+
+        Parse_error() : kind(none), token_index(-1) {}
+
+        Parse_error(kind_type xkind, int xtoken_index, const std::string& xtoken)
+            : kind(xkind), token_index(xtoken_index), token(xtoken) {}
+
+        kind_type kind;
+        /** Index of the offending command line token, or -1. */
+        int token_index;
+        /** The option name or value at fault. */
+        std::string token;
+        /** The option whose value was rejected. */
+        std::string option;
+        /** The options an ambiguous name could stand for, or those a
+            constraint is about. */
+        std::vector<std::string> candidates;
+        /** The config file the error was found in, if any. */
+        std::string file;
+
+        explicit operator bool() const { return kind != none; }
+
+        std::string message() const;
+    };
+
+    /** Thrown by the throwing API for the errors the try_ functions
+        return. */
+    struct Options_error : std::logic_error
+    {
+        explicit Options_error(const Parse_error& e)
+            : std::logic_error(e.message()), error(e) {}
+
+        Parse_error error;
+    };
+
+    /** Either a T or the Parse_error that prevented it, without throwing.
+        value() on an error throws Options_error. */
+    template<class T>
+    class Expected
+    {
+    public:
+        Expected(const T& v) : m_has_value(true) { new (&m_storage) T(v); }
+
+        Expected(T&& v) : m_has_value(true) { new (&m_storage) T(std::move(v)); }
+
+        Expected(const Parse_error& e) : m_has_value(false), m_error(e) {}
+
+        Expected(Parse_error&& e) : m_has_value(false), m_error(std::move(e)) {}
+
+        Expected(const Expected& other)
+            : m_has_value(other.m_has_value), m_error(other.m_error)
+        {
+            if (m_has_value)
+                new (&m_storage) T(*other);
+        }
+
+        Expected(Expected&& other)
+            : m_has_value(other.m_has_value), m_error(std::move(other.m_error))
+        {
+            if (m_has_value)
+                new (&m_storage) T(std::move(*other));
+        }
+
+        Expected& operator=(Expected other)
+        {
+            destroy();
+            m_has_value = other.m_has_value;
+            m_error = std::move(other.m_error);
+            if (m_has_value)
+                new (&m_storage) T(std::move(*other));
+            return *this;
+        }
+
+        ~Expected() { destroy(); }
+
+        bool has_value() const { return m_has_value; }
+
+        explicit operator bool() const { return m_has_value; }
+
+        T& operator*() { return *ptr(); }
+        const T& operator*() const { return *ptr(); }
+        T* operator->() { return ptr(); }
+        const T* operator->() const { return ptr(); }
+
+        T& value()
+        {
+            if (!m_has_value)
+                throw Options_error(m_error);
+            return *ptr();
+        }
+
+        const T& value() const
+        {
+            if (!m_has_value)
+                throw Options_error(m_error);
+            return *ptr();
+        }
+
+        const Parse_error& error() const { return m_error; }
+
+    private:
+        T* ptr() { return reinterpret_cast<T*>(&m_storage); }
+        const T* ptr() const { return reinterpret_cast<const T*>(&m_storage); }
+
+        void destroy()
+        {
+            if (m_has_value)
+                ptr()->~T();
+        }
+
+        bool m_has_value;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+        Parse_error m_error;
+    };
+
+    template<>
+    class Expected<void>
+    {
+    public:
+        Expected() {}
+
+        Expected(const Parse_error& e) : m_error(e) {}
+
+        Expected(Parse_error&& e) : m_error(std::move(e)) {}
+
+        bool has_value() const { return !m_error; }
+
+        explicit operator bool() const { return !m_error; }
+
+        void value() const
+        {
+            if (m_error)
+                throw Options_error(m_error);
+        }
+
+        const Parse_error& error() const { return m_error; }
+
+    private:
+        Parse_error m_error;
+    };
+}
+
+#endif
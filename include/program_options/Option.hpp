@@ -11,21 +11,29 @@ namespace options {
     {
         Basic_option() 
             : position_key(-1)
+            , token_index(-1)
             , unregistered(false) 
             , case_insensitive(false)
+            , hasValue(false)
         {}
 
         Basic_option(const std::string& xstring_key, 
                const std::vector< std::string> &xvalue)
             : string_key(xstring_key)
+            , position_key(-1)
+            , token_index(-1)
             , value(xvalue)
             , unregistered(false)
             , case_insensitive(false)
+            , hasValue(false)
         {}
 
         std::string string_key;
         int position_key;
+        // Index of the command line token the option came from, or -1.
+        int token_index;
         std::vector< std::string > value;
+        // Empty for all but the first option of a '-abc' bundle.
         std::vector< std::string> original_tokens;
         bool unregistered;
         bool case_insensitive;
@@ -7,8 +7,13 @@
 #include <stdexcept>
 #include <iosfwd>
 #include <memory>
+#include <cstdint>
 
 #include "ValueSemantic.hpp"
+#include "Errors.hpp"
+#include "detail/Constraints.hpp"
+#include "detail/DefaultValue.hpp"
+#include "detail/NameTable.hpp"
 
 namespace options {
 
@@ -23,6 +28,10 @@ namespace options {
                            const Value_semantic* s,
                            const char* description);
 
+        OptionDescription(const char* name,
+                           std::shared_ptr<const Value_semantic> s,
+                           const char* description);
+
         virtual ~OptionDescription();
 
         enum match_result { no_match, full_match, approximate_match };
@@ -31,6 +40,14 @@ namespace options {
                            bool long_ignore_case, bool short_ignore_case) const;
         
         const std::string& key(const std::string& option) const;
+
+        /** The name id of key(option), interned at registration. A
+            wildcard option has one id for all the keys it matches, as
+            they come from the input; store() tracks those per map. */
+        unsigned id(const std::string& option) const;
+
+        /** Whether the long name ends with '*'. */
+        bool is_wildcard() const;
         
         std::string canonical_display_name(int canonical_option_style = 0) const;
 
@@ -39,20 +56,43 @@ namespace options {
         const std::string& description() const;
 
         std::shared_ptr<const Value_semantic> semantic() const;
+
+        /* What the parsers ask of semantic() for every option, read once
+           here when the option is made: no virtual call and no shared_ptr
+           copy per use. */
+        const Value_semantic& value_semantic() const { return *m_value_semantic; }
+        unsigned min_tokens() const { return m_min_tokens; }
+        unsigned max_tokens() const { return m_max_tokens; }
+        bool is_composing() const { return m_composing; }
+        bool is_bind_only() const { return m_bind_only; }
+        int builtin_kind() const { return m_builtin_kind; }
         
         std::string format_name() const;
 
         std::string format_parameter() const;
 
     private:
-    
+        friend struct OptionsDescription;
+
         OptionDescription& set_name(const char* name);
 
+        void cache_semantic();
+
+        const std::string& long_name_folded() const;
+
         std::string m_short_name, m_long_name, m_description;
+        // Left empty when folding does not change the name.
+        std::string m_long_name_folded;
+        unsigned m_id;
         std::shared_ptr<const Value_semantic> m_value_semantic;
+        unsigned m_min_tokens, m_max_tokens;
+        bool m_composing, m_bind_only;
+        int m_builtin_kind;
     };
 
     struct  OptionsDescription;
+    namespace detail { struct Description_arena; }
+
     struct  Description_easy_init {
 
         Description_easy_init(OptionsDescription* owner);
@@ -90,25 +130,76 @@ namespace options {
         unsigned get_option_column_width() const;
 
 
+        /** Throws Options_error when 'name' is ambiguous. */
         const OptionDescription* find(const std::string& name,
                                        bool approx, 
                                        bool long_ignore_case = false,
                                        bool short_ignore_case = false) const;
 
+        /** Returns null when 'name' is unknown or ambiguous; in the
+            latter case 'error', if given, says which options matched. */
         const OptionDescription* find_nothrow(const std::string& name,
                                                bool approx,
                                                bool long_ignore_case = false,
-                                               bool short_ignore_case = false) const;
+                                               bool short_ignore_case = false,
+                                               Parse_error* error = 0) const;
 
 
         const std::vector< std::shared_ptr<OptionDescription> >& options() const;
 
+        /** Changes whenever an option is added. Stamps are unique in
+            the process, so that two descriptions only share one when
+            one is an unchanged copy of the other. */
+        unsigned long generation() const { return m_generation; }
+
+        /** Ids of the required options, kept up to date by add(). */
+        const detail::Id_set& required_ids() const { return m_required_ids; }
+
+        /** Ids of the keys of the options, wildcards aside, which are
+            the names the rules below may use. */
+        const detail::Id_set& key_ids() const { return m_key_ids; }
+
+        /** The defaults store() applies, made once per generation()
+            and shared by all the maps they are stored into. */
+        std::shared_ptr<const detail::Defaults> defaults() const;
+
+        /** Rules between options, named by the keys store() uses, that
+            check_constraints() enforces: at most one of 'names' may be
+            given. An option holding just its default is not given, and
+            the keys a wildcard option matches cannot be named.
+            check_constraints() reports a name that is not a key with
+            Parse_error::unknown_rule_option. */
+        OptionsDescription& conflicts(const std::vector<std::string>& names);
+
+        /** 'option', if given, needs all of 'needed' given too. */
+        OptionsDescription& depends(const std::string& option,
+                                    const std::vector<std::string>& needed);
+
+        /** Exactly one of 'names' must be given. */
+        OptionsDescription& one_of(const std::vector<std::string>& names);
+
+        /** At least one of 'names' must be given. */
+        OptionsDescription& at_least_one(const std::vector<std::string>& names);
+
+        /** The rules above, including those of the groups add()ed. */
+        const detail::Constraints& constraints() const { return m_constraints; }
+
         friend std::ostream& operator<<(std::ostream& os, 
                                              const OptionsDescription& desc);
 
         void print(std::ostream& os, unsigned width = 0) const;
 
     private:
+        friend struct Description_easy_init;
+
+        void emplace(const char* name, const Value_semantic* s,
+                     const char* description);
+
+        // Adds option 'i' to the name index below.
+        void index(unsigned i);
+        void place_name(unsigned entry);
+        const std::string& indexed_name(unsigned entry) const;
+
         typedef std::map<std::string, int>::const_iterator name2index_iterator;
         typedef std::pair<name2index_iterator, name2index_iterator> 
             approximation_range;
@@ -121,8 +212,52 @@ namespace options {
 
         std::vector< std::shared_ptr<OptionDescription> > m_options;
 
+        /* Lookup keys parallel to m_options, scanned before any call to
+           match(): the first sixteen case-folded bytes of the long name
+           as two words, and the short option letter. */
+        std::vector<uint64_t> m_long_prefix;
+        std::vector<char> m_short_letter;
+        std::vector<bool> m_wildcard;
+
+        /* The name index find_nothrow() looks up, kept up to date by
+           add(). m_name_table hashes the folded long and short names,
+           wildcards aside, with linear probing: an entry is 2 * i + 1
+           for the long name of option i, 2 * i + 2 for its short name,
+           and 0 when free. m_sorted holds the options with a long name,
+           wildcards aside, in runs sorted by folded long name; the run
+           sizes are the bits of m_sorted.size(), largest first, so that
+           adding an option merges runs like a binary carry. */
+        std::vector<unsigned> m_name_table;
+        unsigned m_name_count;
+        std::vector<unsigned> m_sorted;
+        std::vector<unsigned> m_wildcards;
+
+        /* Backs the options made by add_options(). A copy keeps the
+           options it was given, which keep their arena alive, but adds
+           to an arena of its own, so that copies never write to the
+           same storage. */
+        struct arena_handle
+        {
+            arena_handle() {}
+            arena_handle(const arena_handle&) {}
+            arena_handle(arena_handle&&) = default;
+
+            std::shared_ptr<detail::Description_arena> arena;
+        };
+        arena_handle m_arena;
+
         std::vector<bool> belong_to_group;
 
+        detail::Id_set m_required_ids;
+        detail::Id_set m_key_ids;
+
+        detail::Constraints m_constraints;
+
+        unsigned long m_generation;
+
+        // Read and replaced atomically, as defaults() is const.
+        mutable std::shared_ptr<const detail::Defaults> m_defaults;
+
         std::vector< std::shared_ptr<OptionsDescription> > groups;
 
     };
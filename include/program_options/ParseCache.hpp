@@ -0,0 +1,66 @@
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "OptionsDescription.hpp"
+#include "VariablesMap.hpp"
+
+namespace options {
+
+    /** Remembers the maps parse_args() produced for the most recent
+        distinct command lines. An entry is keyed by the tokens after
+        argv[0] and the description's generation(), so changing the
+        description never brings back an older result. The maps are
+        shared and immutable; copy one to change it. Only successful
+        parses are kept, and variables bound with bind_only() are only
+        written on a miss. Safe to share between threads.
+    */
+    struct ParseCache
+    {
+        /** Keeps at most 'capacity' maps, evicting the least recently
+            used one. */
+        explicit ParseCache(std::size_t capacity = 256);
+
+        /** Same as parse_args(argc, argv, desc), throwing the same
+            errors. */
+        std::shared_ptr<const VariablesMap>
+        parse(int argc, const char* const argv[], const OptionsDescription& desc);
+
+        unsigned long hits() const;
+        unsigned long misses() const;
+        std::size_t size() const;
+
+        void clear();
+
+    private:
+        struct entry {
+            uint64_t hash;
+            unsigned long generation;
+            // The tokens, each followed by a NUL.
+            std::string tokens;
+            std::shared_ptr<const VariablesMap> map;
+        };
+
+        typedef std::list<entry> lru_list;
+
+        lru_list::iterator find(uint64_t hash, unsigned long generation,
+                                const std::string& tokens);
+
+        mutable std::mutex m_mutex;
+        std::size_t m_capacity;
+        // Most recently used first.
+        lru_list m_entries;
+        std::unordered_multimap<uint64_t, lru_list::iterator> m_index;
+        unsigned long m_hits, m_misses;
+    };
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef PARSEOBSERVER_H
+#define PARSEOBSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace options {
+
+    struct OptionDescription;
+    struct Value_semantic;
+
+    /** Receives events from Cmdline::run, store(), parse_config_file()
+        and VariablesMap::notify(), for tracing and profiling. Events that
+        wrap a call into a Value_semantic carry its start and end time,
+        the others the time they happened. Nothing is computed, not even
+        the time, unless an observer is installed; the events arrive on
+        the parsing thread. All handlers default to doing nothing.
+    */
+    struct ParseObserver
+    {
+        typedef std::chrono::steady_clock clock;
+        typedef clock::time_point time_point;
+
+        enum token_kind { long_option, short_option, positional };
+
+        virtual ~ParseObserver() {}
+
+        /** Token 'index' of the command line was recognized as 'kind'. */
+        virtual void token_classified(std::size_t /*index*/,
+                                      const std::string& /*token*/,
+                                      token_kind /*kind*/,
+                                      time_point /*at*/) {}
+
+        /** 'name' was looked up in the description; 'd' is null when
+            the option is not registered. */
+        virtual void option_matched(const std::string& /*name*/,
+                                    const OptionDescription* /*d*/,
+                                    time_point /*at*/) {}
+
+        /** store() converted the tokens of 'name' with 's'. */
+        virtual void value_converted(const std::string& /*name*/,
+                                     const Value_semantic& /*s*/,
+                                     time_point /*start*/,
+                                     time_point /*end*/) {}
+
+        /** store() filled in the default value of 'name'. */
+        virtual void default_applied(const std::string& /*name*/,
+                                     time_point /*at*/) {}
+
+        /** parse_config_file() read and tokenized the file 'path'.
+            Files are read concurrently, but reported in the order
+            they are declared. */
+        virtual void file_loaded(const std::string& /*path*/,
+                                 time_point /*start*/,
+                                 time_point /*end*/) {}
+
+        /** notify() passed the value of 'name' to 's'. */
+        virtual void notify_called(const std::string& /*name*/,
+                                   const Value_semantic& /*s*/,
+                                   time_point /*start*/,
+                                   time_point /*end*/) {}
+    };
+
+    /** Installs 'observer' for all threads and returns the previous
+        one; null uninstalls. An observer must stay alive as long as a
+        parse that started while it was installed may still run. */
+    ParseObserver* set_parse_observer(ParseObserver* observer);
+
+    namespace detail {
+
+        extern std::atomic<ParseObserver*> parse_observer;
+
+        /* Read once at the start of each instrumented call. */
+        inline ParseObserver* observer()
+        {
+            return parse_observer.load(std::memory_order_acquire);
+        }
+
+        inline ParseObserver::time_point now()
+        {
+            return ParseObserver::clock::now();
+        }
+    }
+}
+
+#endif
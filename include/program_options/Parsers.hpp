@@ -4,11 +4,13 @@
 #include <program_options/detail/Cmdline.hpp>
 #include "program_options/OptionsDescription.hpp"
 
+#include <functional>
 #include <iosfwd>
 #include <vector>
 #include <utility>
 #include "Option.hpp"
 #include "OptionEnum.h"
+#include "TokenBuffer.hpp"
 
 namespace options {
 
@@ -16,16 +18,66 @@ namespace options {
     struct PositionalOptionsDescription;
     struct VariablesMap;
 
+    /** The options of one parse, laid out flat: every string of every
+        option lives in 'tokens', and 'entries' says where. An option's
+        key comes first, then its values, then the command line tokens
+        it came from; positional options have an empty key. The
+        Basic_option form is built on request: the former public
+        'options' vector is now options(), a copy (see README.md).
+    */
     struct ParsedOptions
 	{
         explicit ParsedOptions(const OptionsDescription* xdescription, int options_prefix = 0)
         : description(xdescription), m_options_prefix(options_prefix) {}
 
-        std::vector< Basic_option > options;
+        struct entry
+        {
+            entry()
+            : first(0), values(0), originals(0), position_key(-1),
+              token_index(-1), unregistered(false), case_insensitive(false),
+              has_value(false)
+            {}
+
+            /** Index of the key in 'tokens'. */
+            unsigned first;
+            unsigned values;
+            unsigned originals;
+            int position_key;
+            int token_index;
+            bool unregistered;
+            bool case_insensitive;
+            bool has_value;
+        };
+
+        TokenBuffer tokens;
+
+        std::vector<entry> entries;
 
         const OptionsDescription* description;
 
         int m_options_prefix;
+
+        std::size_t size() const { return entries.size(); }
+
+        bool empty() const { return entries.empty(); }
+
+        void clear() { tokens.clear(); entries.clear(); }
+
+        const char* key(std::size_t i) const
+        { return tokens.token(entries[i].first); }
+
+        std::size_t key_length(std::size_t i) const
+        { return tokens.length(entries[i].first); }
+
+        /** Replaces 'out' with the values of option 'i', reusing its
+            strings. */
+        void values(std::size_t i, std::vector<std::string>& out) const;
+
+        Basic_option option(std::size_t i) const;
+
+        std::vector<Basic_option> options() const;
+
+        void push_back(const Basic_option& opt);
     };
 
     struct Basic_command_line_parser : private detail::Cmdline{
@@ -34,6 +86,13 @@ namespace options {
                                   std::basic_string<char> >& args);
         Basic_command_line_parser(int argc, const char* const argv[]);
 
+        /** Takes over the tokens, e.g. the ones split_unix produced. */
+        explicit Basic_command_line_parser(TokenBuffer args);
+
+        /** Wide arguments are converted to UTF-8 once, here. */
+        Basic_command_line_parser(const std::vector<std::wstring>& args);
+        Basic_command_line_parser(int argc, const wchar_t* const argv[]);
+
         Basic_command_line_parser& options(const OptionsDescription& desc);
         Basic_command_line_parser& positional(
             const PositionalOptionsDescription& desc);
@@ -42,6 +101,9 @@ namespace options {
 
         ParsedOptions run();
 
+        /** Like run(), returning the error instead of throwing it. */
+        Expected<ParsedOptions> try_run();
+
         Basic_command_line_parser& allow_unregistered();
 
     private:
@@ -56,12 +118,81 @@ namespace options {
                          enum collect_unrecognized_mode mode);
 
 
+    /** Splits a command line into tokens at unquoted, unescaped
+        separators. Quoted text runs up to the same quote character; an
+        escape character makes the next character literal, in or out of
+        quotes. Quotes and escapes are dropped from the tokens, and
+        empty tokens are kept only when they were quoted, as in "''".
+    */
     std::vector<std::string>
     split_unix(const std::string& cmdline, const std::string& seperator = " \t", 
          const std::string& quote = "'\"", const std::string& escape = "\\");
 
+    /** Same as above, appending the tokens to 'result'. */
+    void
+    split_unix(const std::string& cmdline, TokenBuffer& result,
+         const std::string& seperator = " \t",
+         const std::string& quote = "'\"", const std::string& escape = "\\");
+
     VariablesMap
     parse_args(int argc, const char* const argv[],
                         const OptionsDescription& desc);
+
+    VariablesMap
+    parse_args(int argc, const wchar_t* const argv[],
+                        const OptionsDescription& desc);
+
+    /** Parses and stores without throwing; see Parse_error. */
+    Expected<VariablesMap>
+    try_parse_args(int argc, const char* const argv[],
+                        const OptionsDescription& desc);
+
+    /** Reads a JSON config as it streams in, without building the
+        document in memory. A member is named by its dotted path, as
+        "server.port" in {"server": {"port": 80}}; a scalar becomes its
+        value, null no value, and an array of scalars one value per
+        element. Options 'desc' does not know are dropped. Throws
+        Options_error (invalid_syntax) on malformed JSON. */
+    ParsedOptions
+    parse_json_config(std::istream& is, const OptionsDescription& desc);
+
+    /** Same as above, returning the error instead of throwing it. */
+    Expected<ParsedOptions>
+    try_parse_json_config(std::istream& is, const OptionsDescription& desc);
+
+    /** Reads the environment variables 'name_mapper' maps to an option
+        name; it returns an empty name for the others, and so do names
+        'desc' does not know. Each becomes one option with the value of
+        the variable. */
+    ParsedOptions
+    parse_environment(const OptionsDescription& desc,
+                      const std::function<std::string(const std::string&)>& name_mapper);
+
+    /** Reads the environment variables whose name starts with
+        'prefix', as options named by the rest of the name in lower
+        case: with prefix "APP_", APP_LEVEL=3 is "level". */
+    ParsedOptions
+    parse_environment(const OptionsDescription& desc, const std::string& prefix);
+
+    /** Reads the JSON config file 'path' as parse_json_config() would.
+        A top-level "include" member, a string or an array of them,
+        names further config files relative to the directory of the one
+        that includes them; the last component of each name may hold
+        glob(3) wildcards, whose matches are taken in byte order. The
+        options of the included files take the place of the member, so
+        that storing the result gives them the precedence their order
+        implies. The files of each level of includes are read on up to
+        'threads' threads, or one per core if 0. A file that includes
+        itself is an include_cycle error and one that cannot be read an
+        unreadable_file error; errors in a file name it in 'file'. Each
+        file read is reported to the ParseObserver. */
+    ParsedOptions
+    parse_config_file(const std::string& path, const OptionsDescription& desc,
+                      unsigned threads = 0);
+
+    /** Same as above, returning the error instead of throwing it. */
+    Expected<ParsedOptions>
+    try_parse_config_file(const std::string& path, const OptionsDescription& desc,
+                          unsigned threads = 0);
 }
 #endif
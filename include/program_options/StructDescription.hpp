@@ -0,0 +1,209 @@
+#ifndef STRUCTDESCRIPTION_H
+#define STRUCTDESCRIPTION_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "OptionsDescription.hpp"
+#include "Parsers.hpp"
+#include "ValueSemantic.hpp"
+#include "VariablesMap.hpp"
+
+/** Names a field of 'S' for Struct_description::field, e.g.
+    field<OPTIONS_FIELD(Config, level)>("level,l", "set level", 3). */
+#define OPTIONS_FIELD(S, member) decltype(&S::member), &S::member
+
+namespace options {
+
+    namespace detail {
+
+        template<class P>
+        struct member_pointer_traits;
+
+        template<class S, class T>
+        struct member_pointer_traits<T S::*>
+        {
+            typedef S struct_type;
+            typedef T value_type;
+        };
+
+        /* How a field of type T becomes an option: a bool is a flag, a
+           vector accumulates repeated occurrences, anything else takes
+           one value. */
+        template<class T>
+        typed_value<T>* field_value(T* target)
+        {
+            return value<T>(target);
+        }
+
+        inline typed_value<bool>* field_value(bool* target)
+        {
+            return value<bool>(target)->zero_tokens()->implicit_value(true);
+        }
+
+        template<class T>
+        typed_value< std::vector<T> >* field_value(std::vector<T>* target)
+        {
+            return value< std::vector<T> >(target)->composing();
+        }
+    }
+
+    /** Describes the options of a plain config struct once, by member
+        pointer, so that bind() can produce an OptionsDescription whose
+        options are stored straight into the fields of a given instance
+        (see typed_value::bind_only). Reading the config is then plain
+        member access. Rules between fields are declared as on
+        OptionsDescription and checked by parse() and try_parse().
+
+            Struct_description<Config> d;
+            d.field<OPTIONS_FIELD(Config, level)>("level,l", "set level", 3)
+             .field<OPTIONS_FIELD(Config, verbose)>("verbose,v", "be verbose")
+             .field<OPTIONS_FIELD(Config, quiet)>("quiet,q", "be quiet")
+             .conflicts({"verbose", "quiet"});
+            Config config = d.parse(argc, argv);
+    */
+    template<class S>
+    class Struct_description
+    {
+        struct field_base
+        {
+            virtual ~field_base() {}
+            virtual void add(OptionsDescription& desc, S& s) const = 0;
+        };
+
+        template<class P, P Member>
+        struct field_impl : field_base
+        {
+            typedef typename detail::member_pointer_traits<P>::value_type T;
+
+            field_impl(const char* name, const char* help)
+                : m_name(name), m_help(help), m_has_default(false) {}
+
+            field_impl(const char* name, const char* help, const T& def)
+                : m_name(name), m_help(help), m_default(def),
+                  m_has_default(true) {}
+
+            void add(OptionsDescription& desc, S& s) const
+            {
+                typed_value<T>* v = detail::field_value(&(s.*Member));
+                if (m_has_default)
+                    v->default_value(m_default);
+                desc.add_options()(m_name.c_str(), v->bind_only(),
+                                   m_help.c_str());
+            }
+
+            std::string m_name, m_help;
+            T m_default;
+            bool m_has_default;
+        };
+
+    public:
+        explicit Struct_description(const std::string& caption = "")
+            : m_caption(caption) {}
+
+        /** 'name' is "long" or "long,s", as for add_options(). */
+        template<class P, P Member>
+        Struct_description& field(const char* name, const char* help)
+        {
+            static_assert(std::is_same<
+                typename detail::member_pointer_traits<P>::struct_type, S>::value,
+                "the field must be a member of S");
+            m_fields.push_back(std::make_shared< field_impl<P, Member> >(name, help));
+            return *this;
+        }
+
+        template<class P, P Member>
+        Struct_description& field(const char* name, const char* help,
+            const typename detail::member_pointer_traits<P>::value_type& def)
+        {
+            static_assert(std::is_same<
+                typename detail::member_pointer_traits<P>::struct_type, S>::value,
+                "the field must be a member of S");
+            m_fields.push_back(
+                std::make_shared< field_impl<P, Member> >(name, help, def));
+            return *this;
+        }
+
+        /** See OptionsDescription::conflicts(); the names are those
+            of the fields. */
+        Struct_description& conflicts(const std::vector<std::string>& names)
+        {
+            m_rules.push_back([names](OptionsDescription& d) { d.conflicts(names); });
+            return *this;
+        }
+
+        Struct_description& depends(const std::string& option,
+                                    const std::vector<std::string>& needed)
+        {
+            m_rules.push_back([option, needed](OptionsDescription& d) {
+                d.depends(option, needed);
+            });
+            return *this;
+        }
+
+        Struct_description& one_of(const std::vector<std::string>& names)
+        {
+            m_rules.push_back([names](OptionsDescription& d) { d.one_of(names); });
+            return *this;
+        }
+
+        Struct_description& at_least_one(const std::vector<std::string>& names)
+        {
+            m_rules.push_back([names](OptionsDescription& d) { d.at_least_one(names); });
+            return *this;
+        }
+
+        /** Options writing into 's', which must outlive the result,
+            with the rules declared so far. */
+        OptionsDescription bind(S& s) const
+        {
+            OptionsDescription desc(m_caption);
+            for (const auto& f : m_fields)
+                f->add(desc, s);
+            for (const auto& r : m_rules)
+                r(desc);
+            return desc;
+        }
+
+        /** A value-initialized S with the command line stored into it,
+            checked as by check_constraints(). */
+        S parse(int argc, const char* const argv[]) const
+        {
+            S s = S();
+            OptionsDescription desc = bind(s);
+            VariablesMap vm;
+            store(Basic_command_line_parser(argc, argv).options(desc).run(), vm);
+            check_constraints(vm, desc);
+            return s;
+        }
+
+        /** Same as parse(), without throwing; see Parse_error. */
+        Expected<S> try_parse(int argc, const char* const argv[]) const
+        {
+            S s = S();
+            OptionsDescription desc = bind(s);
+            Expected<ParsedOptions> parsed =
+                Basic_command_line_parser(argc, argv).options(desc).try_run();
+            if (!parsed)
+                return Expected<S>(parsed.error());
+            VariablesMap vm;
+            Expected<void> stored = try_store(*parsed, vm);
+            if (stored)
+                stored = try_check_constraints(vm, desc);
+            if (!stored)
+                return Expected<S>(stored.error());
+            return Expected<S>(std::move(s));
+        }
+
+    private:
+        std::string m_caption;
+        std::vector< std::shared_ptr<const field_base> > m_fields;
+        std::vector< std::function<void(OptionsDescription&)> > m_rules;
+    };
+
+}
+
+#endif
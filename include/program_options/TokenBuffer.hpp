@@ -0,0 +1,60 @@
+#ifndef TOKENBUFFER_H
+#define TOKENBUFFER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace options {
+
+    /** A list of tokens stored back to back in one buffer.
+        Every token is followed by a NUL, so token(i) can be handed to
+        C interfaces, and m_offsets holds one more entry than there are
+        tokens: the end of the last one.
+    */
+    struct TokenBuffer
+    {
+        TokenBuffer() : m_offsets(1, 0) {}
+
+        TokenBuffer(int argc, const char* const argv[]);
+
+        explicit TokenBuffer(const std::vector<std::string>& tokens);
+
+        std::size_t size() const { return m_offsets.size() - 1; }
+
+        bool empty() const { return size() == 0; }
+
+        const char* token(std::size_t i) const
+        { return m_data.data() + m_offsets[i]; }
+
+        std::size_t length(std::size_t i) const
+        { return m_offsets[i+1] - m_offsets[i] - 1; }
+
+        std::string str(std::size_t i) const
+        { return std::string(token(i), length(i)); }
+
+        void push_back(const char* s, std::size_t n);
+
+        void push_back(const std::string& s) { push_back(s.data(), s.size()); }
+
+        void clear();
+
+        void reserve(std::size_t bytes, std::size_t tokens);
+
+        /* For tokenizers: append to the token under construction and
+           terminate it. */
+        void append(const char* first, const char* last)
+        { m_data.append(first, last); }
+
+        void append(char c) { m_data.push_back(c); }
+
+        void finish();
+
+    private:
+        std::string m_data;
+        std::vector<std::size_t> m_offsets;
+    };
+
+}
+
+#endif
@@ -1,9 +1,13 @@
 #ifndef VALUESEMANTIC_H
 #define VALUESEMANTIC_H
 
+#include <functional>
 #include <string>
 #include <vector>
+#include <limits>
+#include <type_traits>
 #include "Any.hpp"
+#include "detail/BuiltinValue.hpp"
 
 namespace options {
 
@@ -21,9 +25,51 @@ namespace options {
                            const std::vector<std::string>& new_tokens) const
             = 0;
 
+        /** Same as parse(), but says whether the tokens were valid.
+            Semantics that cannot tell accept everything. */
+        virtual bool parse_checked(Any& value_store,
+                                   const std::vector<std::string>& new_tokens) const
+        {
+            parse(value_store, new_tokens);
+            return true;
+        }
+
         virtual bool apply_default(Any& value_store) const = 0;
+
+        /** Computes the default in place of apply_default(), for a
+            VariablesMap to call when the value is first read. Empty
+            when the default, if any, is a plain value. */
+        virtual std::function<Any()> default_callback() const
+        {
+            return std::function<Any()>();
+        }
+
+        /** A bind-only semantic writes its bound variable from store()
+            itself, and the option gets no VariablesMap entry. */
+        virtual bool is_bind_only() const { return false; }
+
+        /** Bind-only: converts the tokens into the bound variable, reset
+            first if 'first'. Returns false, leaving it alone, if invalid. */
+        virtual bool parse_bound(const std::vector<std::string>& /*new_tokens*/,
+                                 bool /*first*/) const
+        {
+            return false;
+        }
+
+        /** Bind-only: writes the default value, if any, into the bound
+            variable. */
+        virtual bool apply_default_bound() const { return false; }
+
+        /** A detail::builtin_kind other than custom_kind promises that
+            parse() of non-empty tokens is detail::parse_builtin() of
+            that kind, which store() then calls directly. */
+        virtual int builtin_kind() const { return detail::custom_kind; }
                                    
         virtual void notify(const Any& value_store) const = 0;
+
+        /** False if notify() ignores its value, which then need not be
+            computed. */
+        virtual bool notifies() const { return true; }
         
         virtual ~Value_semantic() {}
     };
@@ -38,17 +84,41 @@ namespace options {
     private: // base overrides
         void parse(Any& value_store, 
                    const std::vector<std::string>& new_tokens) const;
+        bool parse_checked(Any& value_store,
+                           const std::vector<std::string>& new_tokens) const;
     protected: // interface for derived classes.
         virtual void xparse(Any& value_store, 
                             const std::vector<std::string>& new_tokens) 
             const = 0;
+        virtual bool xparse_checked(Any& value_store,
+                                    const std::vector<std::string>& new_tokens)
+            const
+        {
+            xparse(value_store, new_tokens);
+            return true;
+        }
     };
 
+    /* Tokens always arrive as UTF-8; they are converted to wide strings
+       here, once per parse, before reaching the typed xparse. */
     template<>
     struct Value_semantic_codecvt_helper<wchar_t> : public Value_semantic {
     private: // base overrides
         void parse(Any& value_store, 
                    const std::vector<std::string>& new_tokens) const;
+        bool parse_checked(Any& value_store,
+                           const std::vector<std::string>& new_tokens) const;
+    protected: // interface for derived classes.
+        virtual void xparse(Any& value_store, 
+                            const std::vector<std::wstring>& new_tokens) 
+            const = 0;
+        virtual bool xparse_checked(Any& value_store,
+                                    const std::vector<std::wstring>& new_tokens)
+            const
+        {
+            xparse(value_store, new_tokens);
+            return true;
+        }
     };
 
     struct Untyped_value : public Value_semantic_codecvt_helper<char>
@@ -90,18 +160,34 @@ namespace options {
         typed_value(T* store_to) 
         : m_store_to(store_to), m_composing(false),
           m_multitoken(false), m_zero_tokens(false),
-          m_required(false)
+          m_required(false), m_bind_only(false), m_delimiter(0)
         {} 
 
         typed_value* default_value(const T& v)
         {
             m_default_value = Any(v);
+            m_default_callback = std::function<Any()>();
             return this;
         }
 
         typed_value* default_value(const T& v, const std::string& textual)
         {
             m_default_value = Any(v);
+            m_default_callback = std::function<Any()>();
+            m_default_value_as_text = textual;
+            return this;
+        }
+
+        /** A default that costs something to find out, such as the
+            number of cores: 'f' is called the first time the value is
+            read from a VariablesMap, once for all the maps the
+            description stores into, and not at all if it never is.
+            With bind_only(), store() calls it to write the variable. */
+        typed_value* lazy_default_value(std::function<T()> f,
+                                        const std::string& textual)
+        {
+            m_default_value = Any();
+            m_default_callback = [f] { return Any(f()); };
             m_default_value_as_text = textual;
             return this;
         }
@@ -149,6 +235,22 @@ namespace options {
             return this;
         }
 
+        /** Values go straight into the variable given to value(), with
+            no VariablesMap entry, no Any and nothing left for notify(). */
+        typed_value* bind_only()
+        {
+            m_bind_only = true;
+            return this;
+        }
+
+        /** Each token holds a whole list, e.g. '--ids=1,5,9'. Meant for
+            std::vector<T>; integer elements use a vectorized parser. */
+        typed_value* delimiter(charT c)
+        {
+            m_delimiter = c;
+            return this;
+        }
+
     public: // value semantic overrides
 
         std::string name() const;
@@ -166,7 +268,7 @@ namespace options {
 
         unsigned max_tokens() const {
             if (m_multitoken) {
-                return 32000;
+                return (std::numeric_limits<unsigned>::max)();
             } else if (m_zero_tokens) {
                 return 0;
             } else {
@@ -180,9 +282,16 @@ namespace options {
                     const std::vector< std::basic_string<charT> >& new_tokens) 
             const;
 
+        bool xparse_checked(Any& value_store,
+                    const std::vector< std::basic_string<charT> >& new_tokens)
+            const;
+
         virtual bool apply_default(Any& value_store) const
         {
-            if (m_default_value.empty()) {
+            if (m_default_callback) {
+                value_store = m_default_callback();
+                return true;
+            } else if (m_default_value.empty()) {
                 return false;
             } else {
                 value_store = m_default_value;
@@ -190,8 +299,28 @@ namespace options {
             }
         }
 
+        std::function<Any()> default_callback() const
+        {
+            return m_default_callback;
+        }
+
         void notify(const Any& value_store) const;
 
+        bool notifies() const { return m_store_to != 0; }
+
+        bool is_bind_only() const { return m_bind_only && m_store_to; }
+
+        bool parse_bound(const std::vector<std::string>& new_tokens,
+                         bool first) const;
+
+        bool apply_default_bound() const;
+
+        int builtin_kind() const
+        {
+            return std::is_same<charT, char>::value && !m_delimiter
+                ? int(detail::builtin_kind_of<T>::value) : int(detail::custom_kind);
+        }
+
     public: // typed_value_base overrides
         
         
@@ -201,10 +330,13 @@ namespace options {
 
         std::string m_value_name;
         Any m_default_value;
+        std::function<Any()> m_default_callback;
         std::string m_default_value_as_text;
         Any m_implicit_value;
         std::string m_implicit_value_as_text;
         bool m_composing, m_implicit, m_multitoken, m_zero_tokens, m_required;
+        bool m_bind_only;
+        charT m_delimiter;
         
     };
 
@@ -217,6 +349,14 @@ namespace options {
     typed_value<T>*
     value(T* v);
 
+    template<class T>
+    typed_value<T, wchar_t>*
+    wvalue();
+
+    template<class T>
+    typed_value<T, wchar_t>*
+    wvalue(T* v);
+
 
 
 }
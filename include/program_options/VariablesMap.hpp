@@ -4,24 +4,81 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
+#include <unordered_map>
 #include "Any.hpp"
+#include "Errors.hpp"
+#include "detail/DefaultValue.hpp"
+#include "detail/NameTable.hpp"
 #include <memory>
 
 namespace options {
 
     struct  ParsedOptions;
+    struct OptionsDescription;
     struct Value_semantic;
     struct VariablesMap;
+    struct FlatVariablesMap;
 
     void store(const ParsedOptions& options, VariablesMap& m);
 
+    /** Like store(), but stops at the first ambiguous option or invalid
+        value and returns it instead of throwing. */
+    Expected<void> try_store(const ParsedOptions& options, VariablesMap& m);
+
+    /** Like store(), converting the values of different options, and
+        parts of large built-in vectors, on up to 'threads' threads, or
+        one per core if 0. The map ends up as store() would
+        leave it. Unlike store(), nothing is stored when an exception is
+        thrown, and options bound with bind_only() are written on the
+        calling thread. Parses with fewer than a few thousand values are
+        simply stored.
+    */
+    void store_parallel(const ParsedOptions& options, VariablesMap& m,
+                        unsigned threads = 0);
+
+    /** Like store_parallel(), returning the first invalid value instead
+        of skipping it. The map is left alone if the value is not that
+        of a bound option. */
+    Expected<void> try_store_parallel(const ParsedOptions& options,
+                                      VariablesMap& m, unsigned threads = 0);
+
+    /** Stores several sources in one pass, 'sources' first to last in
+        order of precedence: the result is that of calling store() on
+        each in turn, except that the defaults of their descriptions are
+        applied once, after the last one, and their constraints are
+        checked as by check_constraints(). Every value records which
+        source it came from, by its index in 'sources', with defaults
+        counting as source sources.size(). At most 65535 sources.
+    */
+    void store_sources(const std::vector<const ParsedOptions*>& sources,
+                       VariablesMap& m);
+
+    /** Like store_sources(), stopping at the first ambiguous option or
+        invalid value as try_store() does. */
+    Expected<void>
+    try_store_sources(const std::vector<const ParsedOptions*>& sources,
+                      VariablesMap& m);
+
+    /** Checks what store() recorded in 'm' against the rules declared
+        on 'desc' with conflicts(), depends(), one_of() and
+        at_least_one(), all of them in one pass, and throws
+        Options_error for the first one broken. parse_args() and
+        store_sources() check on their own; a chain of store() calls
+        is checked once, after the last one. */
+    void check_constraints(const VariablesMap& m, const OptionsDescription& desc);
+
+    /** Like check_constraints(), returning the error instead. */
+    Expected<void> try_check_constraints(const VariablesMap& m,
+                                         const OptionsDescription& desc);
+
     void notify(VariablesMap& m);
 
     struct  VariableValue
     {
-        VariableValue() : defaulted(false) {}
+        VariableValue() : defaulted(false), m_source(0), m_position(-1) {}
         VariableValue(const Any& xv, bool xdefaulted) 
-        : v(xv), defaulted(xdefaulted) 
+        : v(xv), defaulted(xdefaulted), m_source(0), m_position(-1)
         {}
 
         bool empty() const;
@@ -29,12 +86,29 @@ namespace options {
         const Any& value() const;
 
         Any& value();
+
+        /** The index of the source the value was stored from; see
+            store_sources(). store() records source 0. */
+        unsigned source() const { return m_source; }
+
+        /** The command line token of the occurrence that last set the
+            value, or for sources without tokens its index among the
+            source's options; -1 for defaults. */
+        int position() const { return m_position; }
    
         Any v;
         bool defaulted;
+        // Kept next to 'defaulted', in what would otherwise be padding.
+        unsigned short m_source;
+        int m_position;
 
         std::shared_ptr<const Value_semantic> m_value_semantic;
 
+        /* A default shared with every other map its description stored
+           it into, read while 'v' is empty. The non-const value() makes
+           a copy of its own first. */
+        std::shared_ptr<const detail::Default_value> m_default;
+
         friend 
         void store(const ParsedOptions& options, 
               VariablesMap& m, bool);
@@ -51,12 +125,29 @@ namespace options {
 
         const VariableValue& operator[](const std::string& name) const;
 
-        void next(AbstractVariablesMap* next);
+        void next(const AbstractVariablesMap* next);
+
+        /** Resolves the whole m_next chain into a single hashed view. */
+        FlatVariablesMap flatten() const;
+
+        /** Bumped whenever the content or the m_next link of this layer
+            changes; FlatVariablesMap::stale() compares it. Edits made
+            through the std::map interface of a VariablesMap bump it
+            only when followed by touch(). */
+        unsigned long generation() const { return m_generation; }
+
+    protected:
+        void touch() { ++m_generation; }
 
     private:
         virtual const VariableValue& get(const std::string& name) const = 0;
 
+        virtual void names(std::vector<std::string>& result) const = 0;
+
         const AbstractVariablesMap* m_next;
+        unsigned long m_generation;
+
+        friend struct FlatVariablesMap;
     };
 
     struct  VariablesMap : private AbstractVariablesMap,
@@ -68,6 +159,16 @@ namespace options {
         const VariableValue& operator[](const std::string& name) const
         { return AbstractVariablesMap::operator[](name); }
 
+        void next(const VariablesMap* next)
+        { AbstractVariablesMap::next(next); }
+
+        using AbstractVariablesMap::flatten;
+        using AbstractVariablesMap::generation;
+
+        // Must be called after modifying the map through the std::map
+        // interface, so that flattened views built on it are refreshed.
+        using AbstractVariablesMap::touch;
+
         void clear(); 
         
         bool has(const std::string& name) const;
@@ -76,20 +177,75 @@ namespace options {
 
         const VariableValue& get(const std::string& name) const;
 
-        std::set<std::string> m_final;
+        void names(std::vector<std::string>& result) const;
+
+        /* Name ids (see detail::name_id) of the options store() has
+           given a final value, of the required options of every
+           description stored so far, of the options store() has given
+           a value, defaults included, and of those whose value is still
+           the default. Options bound with bind_only() are tracked here
+           although they have no entry in the map. */
+        detail::Id_set m_final;
 
         friend 
         void store(const ParsedOptions& options, 
                           VariablesMap& xm,
                           bool utf8);
         
-        std::map<std::string, std::string> m_required;
+        detail::Id_set m_required;
+        detail::Id_set m_present;
+        detail::Id_set m_defaulted;
+
+        /* The same for the keys of wildcard options, which come from
+           the input: numbered per map by m_wildcard_ids instead of
+           being interned for the whole process. */
+        std::unordered_map<std::string, unsigned> m_wildcard_ids;
+        detail::Id_set m_wildcard_final;
+        detail::Id_set m_wildcard_present;
+        detail::Id_set m_wildcard_defaulted;
+
+        friend struct VariablesOverlay;
+    };
+
+    /** Read-optimized, frozen snapshot of an AbstractVariablesMap
+        chain. Every name known to any layer is resolved once, with the
+        same precedence rules as AbstractVariablesMap::operator[], and
+        its value copied into a hash table. A lookup is one hash probe
+        and never looks at the layers: the view changes only when
+        refresh() rebuilds it. Until then it may be read from several
+        threads and outlive its layers.
+    */
+    struct FlatVariablesMap
+    {
+        FlatVariablesMap();
+        explicit FlatVariablesMap(const AbstractVariablesMap& head);
+
+        const VariableValue& operator[](const std::string& name) const;
+
+        bool has(const std::string& name) const;
+
+        std::size_t size() const;
+
+        /** Whether a layer changed since the view was built, through
+            store(), clear(), next(), VariablesOverlay::set() or erase(),
+            or any edit followed by touch(). The layers must be alive. */
+        bool stale() const;
+
+        /** Rebuilds the view from the chain, which must be alive. */
+        void refresh();
+
+    private:
+        typedef std::pair<const AbstractVariablesMap*, unsigned long> layer;
+
+        const AbstractVariablesMap* m_head;
+        std::vector<layer> m_layers;
+        std::unordered_map<std::string, VariableValue> m_values;
     };
 
     inline bool
     VariableValue::empty() const
     {
-        return v.empty();
+        return v.empty() && !m_default;
     }
 
     inline bool
@@ -102,13 +258,19 @@ namespace options {
     const Any&
     VariableValue::value() const
     {
-        return v;
+        return m_default && v.empty() ? m_default->get() : v;
     }
 
     inline
     Any&
     VariableValue::value()
     {
+        if (m_default)
+        {
+            if (v.empty())
+                v = m_default->get();
+            m_default.reset();
+        }
         return v;
     }
 
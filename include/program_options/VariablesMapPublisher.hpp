@@ -0,0 +1,123 @@
+#ifndef VARIABLESMAPPUBLISHER_H
+#define VARIABLESMAPPUBLISHER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "VariablesMap.hpp"
+
+namespace options {
+
+    /** Publishes immutable VariablesMap snapshots to concurrent readers.
+        A control thread calls publish() with a freshly built map; reader
+        threads each subscribe() once and then call read() as often as
+        they like. A read announces the current epoch in the subscriber's
+        own cache line and loads the current snapshot: no lock, no
+        reference count and no read-modify-write on shared data, so
+        readers never wait for each other or for the publisher.
+        Replaced snapshots are retired with the epoch in which they were
+        unpublished and freed by a later publish() or reclaim() once no
+        subscriber announced an epoch old enough to still see them.
+        A Subscriber may be moved, into a growing vector say, while its
+        snapshots are alive, but must outlive them.
+    */
+    class VariablesMapPublisher
+    {
+        struct slot
+        {
+            std::atomic<unsigned long> epoch;
+            std::atomic<bool> used;
+            // Snapshots alive, only touched by the subscriber's thread.
+            // Kept here rather than in the Subscriber so that snapshots
+            // need not go through it, which may have moved.
+            unsigned depth;
+            // Keep each subscriber's epoch on its own cache line.
+            char padding[64 - sizeof(std::atomic<unsigned long>)
+                         - sizeof(std::atomic<bool>) - sizeof(unsigned)];
+        };
+
+    public:
+        class Subscriber;
+
+        /** Keeps the subscriber's snapshot alive until destroyed. */
+        class Snapshot
+        {
+        public:
+            Snapshot(Snapshot&& other);
+            ~Snapshot();
+
+            const VariablesMap& operator*() const { return *m_map; }
+            const VariablesMap* operator->() const { return m_map; }
+            const VariablesMap* get() const { return m_map; }
+
+        private:
+            Snapshot(slot* s, const VariablesMap* map);
+            Snapshot(const Snapshot&);
+            Snapshot& operator=(const Snapshot&);
+
+            slot* m_slot;
+            const VariablesMap* m_map;
+
+            friend class Subscriber;
+        };
+
+        /** A reader's registration; use from one thread at a time. */
+        class Subscriber
+        {
+        public:
+            Subscriber(Subscriber&& other);
+            ~Subscriber();
+
+            Snapshot read();
+
+        private:
+            Subscriber(VariablesMapPublisher* owner, slot* s);
+            Subscriber(const Subscriber&);
+            Subscriber& operator=(const Subscriber&);
+
+            VariablesMapPublisher* m_owner;
+            slot* m_slot;
+
+            friend class VariablesMapPublisher;
+        };
+
+        explicit VariablesMapPublisher(unsigned max_subscribers = 128);
+
+        VariablesMapPublisher(std::unique_ptr<const VariablesMap> initial,
+                              unsigned max_subscribers = 128);
+
+        /** All subscribers must be gone by now. */
+        ~VariablesMapPublisher();
+
+        void publish(std::unique_ptr<const VariablesMap> next);
+
+        void publish(const VariablesMap& next);
+
+        /** Throws std::length_error when all slots are taken. */
+        Subscriber subscribe();
+
+        /** Frees retired snapshots no reader can still see and returns
+            the number still waiting for readers to move on. */
+        std::size_t reclaim();
+
+    private:
+        VariablesMapPublisher(const VariablesMapPublisher&);
+        VariablesMapPublisher& operator=(const VariablesMapPublisher&);
+
+        std::size_t reclaim_locked();
+
+        std::atomic<const VariablesMap*> m_current;
+        std::atomic<unsigned long> m_epoch;
+        std::unique_ptr<slot[]> m_slots;
+        const unsigned m_slot_count;
+
+        std::mutex m_writer;
+        std::vector< std::pair<const VariablesMap*, unsigned long> > m_retired;
+    };
+
+}
+
+#endif
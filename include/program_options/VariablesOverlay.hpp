@@ -0,0 +1,61 @@
+#ifndef VARIABLESOVERLAY_H
+#define VARIABLESOVERLAY_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+
+#include "VariablesMap.hpp"
+
+namespace options {
+
+    /** A cheap variant of a shared VariablesMap.
+        The overlay keeps a reference to the base map instead of a copy
+        and stores only the overridden values, as a vector sorted by name.
+        Lookups follow AbstractVariablesMap rules with the base as the
+        next layer: an override wins unless it is empty or defaulted while
+        the base holds an explicit value.
+    */
+    struct VariablesOverlay : public AbstractVariablesMap
+    {
+        typedef std::pair<std::string, VariableValue> override_type;
+
+        explicit VariablesOverlay(std::shared_ptr<const VariablesMap> base);
+
+        VariablesOverlay(std::shared_ptr<const VariablesMap> base,
+                         std::vector<override_type> overrides);
+
+        VariablesOverlay& set(const std::string& name, const VariableValue& v);
+
+        VariablesOverlay& set(const std::string& name, const Any& v);
+
+        bool erase(const std::string& name);
+
+        bool has(const std::string& name) const;
+
+        bool overrides(const std::string& name) const;
+
+        std::size_t override_count() const { return m_overrides.size(); }
+
+        const std::shared_ptr<const VariablesMap>& base() const
+        { return m_base; }
+
+    private:
+        // The base is always the next layer.
+        using AbstractVariablesMap::next;
+
+        const VariableValue& get(const std::string& name) const;
+
+        void names(std::vector<std::string>& result) const;
+
+        std::vector<override_type>::const_iterator
+        lookup(const std::string& name) const;
+
+        std::shared_ptr<const VariablesMap> m_base;
+        std::vector<override_type> m_overrides;
+    };
+
+}
+
+#endif
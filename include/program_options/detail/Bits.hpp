@@ -0,0 +1,33 @@
+#ifndef BITS_H
+#define BITS_H
+
+#include <cstdint>
+
+namespace options { namespace detail {
+
+    /* The index of the lowest set bit of 'x', which must not be 0. */
+    inline unsigned count_trailing_zeros(uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+        unsigned n = 0;
+        while (!(x & 1)) { x >>= 1; ++n; }
+        return n;
+#endif
+    }
+
+    inline unsigned popcount(uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+        unsigned n = 0;
+        for (; x; x &= x - 1) ++n;
+        return n;
+#endif
+    }
+
+}}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef BUILTINVALUE_H
+#define BUILTINVALUE_H
+
+#include <string>
+#include <vector>
+
+#include "../Any.hpp"
+
+namespace options { namespace detail {
+
+    /* The value types store() converts with a switch instead of the
+       virtual parse() -> xparse() -> validate() chain. Anything else,
+       including user types, is custom_kind and keeps the virtual path.
+    */
+    enum builtin_kind {
+        custom_kind = 0,
+        bool_kind, int_kind, unsigned_kind, long_kind, unsigned_long_kind,
+        long_long_kind, unsigned_long_long_kind, float_kind, double_kind,
+        string_kind,
+        int_vector_kind, unsigned_vector_kind, long_vector_kind,
+        long_long_vector_kind, double_vector_kind, string_vector_kind
+    };
+
+    template<class T> struct builtin_kind_of { enum { value = custom_kind }; };
+
+    template<> struct builtin_kind_of<bool> { enum { value = bool_kind }; };
+    template<> struct builtin_kind_of<int> { enum { value = int_kind }; };
+    template<> struct builtin_kind_of<unsigned> { enum { value = unsigned_kind }; };
+    template<> struct builtin_kind_of<long> { enum { value = long_kind }; };
+    template<> struct builtin_kind_of<unsigned long> { enum { value = unsigned_long_kind }; };
+    template<> struct builtin_kind_of<long long> { enum { value = long_long_kind }; };
+    template<> struct builtin_kind_of<unsigned long long> { enum { value = unsigned_long_long_kind }; };
+    template<> struct builtin_kind_of<float> { enum { value = float_kind }; };
+    template<> struct builtin_kind_of<double> { enum { value = double_kind }; };
+    template<> struct builtin_kind_of<std::string> { enum { value = string_kind }; };
+    template<> struct builtin_kind_of< std::vector<int> > { enum { value = int_vector_kind }; };
+    template<> struct builtin_kind_of< std::vector<unsigned> > { enum { value = unsigned_vector_kind }; };
+    template<> struct builtin_kind_of< std::vector<long> > { enum { value = long_vector_kind }; };
+    template<> struct builtin_kind_of< std::vector<long long> > { enum { value = long_long_vector_kind }; };
+    template<> struct builtin_kind_of< std::vector<double> > { enum { value = double_vector_kind }; };
+    template<> struct builtin_kind_of< std::vector<std::string> > { enum { value = string_vector_kind }; };
+
+    /* Converts non-empty 'tokens' as typed_value<T>::xparse() would for
+       the T of 'kind', or as xparse_checked() if 'checked', returning
+       its answer. Unchecked, the result is always true. */
+    bool parse_builtin(int kind, Any& value_store,
+                       const std::vector<std::string>& tokens, bool checked);
+
+    /* Whether values of 'kind' are vectors, which parse_builtin()
+       appends to. */
+    inline bool is_builtin_vector(int kind)
+    {
+        return kind >= int_vector_kind && kind <= string_vector_kind;
+    }
+
+    /* Moves the elements of the vector in 'from' to the end of the one
+       in 'to', or the vector itself if 'to' is empty. Both hold the
+       type of 'kind', which is_builtin_vector(). */
+    void append_builtin(int kind, Any& to, Any& from);
+
+}}
+
+#endif
@@ -7,9 +7,14 @@
 #include "../Option.hpp"
 #include "../OptionsDescription.hpp"
 #include "../PositionalOptions.hpp"
+#include "../TokenBuffer.hpp"
 
 
-namespace options { namespace detail {
+namespace options {
+
+    struct ParsedOptions;
+
+namespace detail {
 
     struct Cmdline
 	{
@@ -18,22 +23,55 @@ namespace options { namespace detail {
 
         Cmdline(int argc, const char** argv);
 
+        Cmdline(TokenBuffer args);
+
         void allow_unregistered();
 
         void set_options_description(const OptionsDescription& desc);
 
-        std::vector<Option> run();
+        /* Appends the options to 'result'. An ambiguous option name is
+           reported in 'error' when given, leaving 'result' incomplete,
+           and thrown otherwise. */
+        void run(ParsedOptions& result, Parse_error* error = 0);
 
-        std::vector<Option> parse_long_option(const string& arg);
-        std::vector<Option> parse_short_option(const string& args);
+        void init(TokenBuffer args);
 
-        void init(const std::vector<std::string>& args);
+        /* The tokens the next run() parses; refilling them in place
+           keeps their buffers. */
+        TokenBuffer& tokens() { return args; }
 
 	private:
-        std::vector<std::string> args;
+        /* An option or positional argument found in a token by the
+           first pass, pointing into 'args' or into the description.
+           An unknown short option has no key but its letter. */
+        struct item
+        {
+            const char* key;
+            std::size_t key_length;
+            const char* value;
+            std::size_t value_length;
+            unsigned token;
+            char letter;
+            // The first item of a token records the token.
+            bool first;
+            bool has_value;
+
+            bool positional() const { return !key_length && !letter; }
+        };
+
+        void classify_long(unsigned token);
+        void classify_short(unsigned token);
+        void append(ParsedOptions& result, const item& it,
+                    std::size_t absorbed, int position_key);
+
+        TokenBuffer args;
         bool m_allow_unregistered;
 
         const OptionsDescription* m_desc;
+
+        // Reused from one run to the next.
+        std::vector<item> m_items;
+        std::string m_name;
     };
     
     void test_cmdline_detail();
@@ -0,0 +1,63 @@
+#ifndef CONSTRAINTS_H
+#define CONSTRAINTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../Errors.hpp"
+#include "NameTable.hpp"
+
+namespace options { namespace detail {
+
+    /* The rules declared with OptionsDescription::conflicts() and the
+       like, each compiled to the non-zero words of the id set of its
+       options, so that checking a rule is an AND and a popcount per
+       word of what was given. */
+    class Constraints
+    {
+    public:
+        enum kind_type { conflicts, depends, one_of, at_least_one };
+
+        /* For depends, 'subject' needs all of 'names'. */
+        void add(kind_type kind, const std::vector<std::string>& names,
+                 const std::string& subject = std::string());
+
+        void add(const Constraints& other);
+
+        bool empty() const { return m_rules.empty(); }
+
+        /* Checks that every option the rules name is in 'keys', then
+           every rule against the options in 'present' but not in
+           'defaulted', in the order they were added. The first unknown
+           name or broken rule is described in 'error', with no
+           token_index. */
+        bool check(const Id_set& keys, const Id_set& present,
+                   const Id_set& defaulted, Parse_error& error) const;
+
+    private:
+        struct rule
+        {
+            kind_type kind;
+            unsigned subject;
+            // Ranges of m_masks and m_ids.
+            std::size_t mask_begin, mask_end;
+            std::size_t id_begin, id_end;
+        };
+
+        bool known(const rule& r, const Id_set& keys, Parse_error& error) const;
+
+        void fail(const rule& r, unsigned given, const Id_set& present,
+                  const Id_set& defaulted, Parse_error& error) const;
+
+        std::vector<rule> m_rules;
+        // Word index and bits, in increasing word order per rule.
+        std::vector< std::pair<std::size_t, uint64_t> > m_masks;
+        // The options of each rule as declared, for messages.
+        std::vector<unsigned> m_ids;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "Utf8.hpp"
+
+namespace options { namespace detail {
+
+    /* Direct text to value conversions for the built-in types, used where
+       going through a temporary Any per element would be wasteful.
+       Each returns false and leaves 'out' untouched if the whole of
+       [first, last) is not a valid value of the target type.
+    */
+
+    template<class T>
+    struct is_direct_convertible
+    {
+        enum { value = std::is_arithmetic<T>::value ||
+                       std::is_same<T, std::string>::value ||
+                       std::is_same<T, std::wstring>::value };
+    };
+
+    bool convert(const char* first, const char* last, bool& out);
+
+    bool convert(const char* first, const char* last, char& out);
+
+    inline bool convert(const char* first, const char* last, std::string& out)
+    {
+        out.assign(first, last);
+        return true;
+    }
+
+    inline bool convert(const char* first, const char* last, std::wstring& out)
+    {
+        out.clear();
+        from_utf8(first, static_cast<std::size_t>(last - first), out);
+        return true;
+    }
+
+    bool parse_signed(const char* first, const char* last,
+                      long long min, long long max, long long& out);
+
+    bool parse_unsigned(const char* first, const char* last,
+                        unsigned long long max, unsigned long long& out);
+
+    bool parse_floating(const char* first, const char* last, long double& out);
+
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value &&
+                            std::is_signed<T>::value, bool>::type
+    convert(const char* first, const char* last, T& out)
+    {
+        long long x;
+        if (!parse_signed(first, last, std::numeric_limits<T>::min(),
+                          std::numeric_limits<T>::max(), x))
+            return false;
+        out = static_cast<T>(x);
+        return true;
+    }
+
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value &&
+                            std::is_unsigned<T>::value &&
+                            !std::is_same<T, bool>::value, bool>::type
+    convert(const char* first, const char* last, T& out)
+    {
+        unsigned long long x;
+        if (!parse_unsigned(first, last, std::numeric_limits<T>::max(), x))
+            return false;
+        out = static_cast<T>(x);
+        return true;
+    }
+
+    template<class T>
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+    convert(const char* first, const char* last, T& out)
+    {
+        long double x;
+        if (!parse_floating(first, last, x))
+            return false;
+        out = static_cast<T>(x);
+        return true;
+    }
+
+    /** Fallback for user types: a full stream extraction. */
+    template<class T>
+    typename std::enable_if<!is_direct_convertible<T>::value, bool>::type
+    convert(const char* first, const char* last, T& out)
+    {
+        std::istringstream ss(std::string(first, last));
+        T x;
+        if (!(ss >> x) || ss.get() != std::char_traits<char>::eof())
+            return false;
+        out = x;
+        return true;
+    }
+
+    template<class T>
+    bool convert(const std::string& s, T& out)
+    {
+        return convert(s.data(), s.data() + s.size(), out);
+    }
+
+    inline bool convert(const std::wstring& s, std::wstring& out)
+    {
+        out = s;
+        return true;
+    }
+
+    /* Wide tokens of other types are converted from their UTF-8 form. */
+    template<class T>
+    bool convert(const std::wstring& s, T& out)
+    {
+        std::string narrow;
+        to_utf8(s.data(), s.size(), narrow);
+        return convert(narrow, out);
+    }
+
+}}
+
+#endif
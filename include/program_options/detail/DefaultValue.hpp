@@ -0,0 +1,61 @@
+#ifndef DEFAULTVALUE_H
+#define DEFAULTVALUE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../Any.hpp"
+
+namespace options {
+
+    struct Value_semantic;
+
+namespace detail {
+
+    /* A default value as the VariablesMap entries holding it share it:
+       either made up front, or computed by a callback the first time
+       any of them reads it. A callback that throws is called again on
+       the next read. */
+    class Default_value
+    {
+    public:
+        explicit Default_value(Any value);
+        explicit Default_value(std::function<Any()> compute);
+
+        const Any& get() const;
+
+        /* Whether get() would still call the callback. */
+        bool pending() const;
+
+    private:
+        std::function<Any()> m_compute;
+        mutable std::once_flag m_once;
+        mutable Any m_value;
+        mutable std::atomic<bool> m_ready;
+    };
+
+    /* The options of a description that have a default, in its order,
+       as OptionsDescription::defaults() hands them to store(). */
+    struct Defaults
+    {
+        struct entry
+        {
+            std::string key;
+            unsigned id;
+            std::shared_ptr<const Value_semantic> semantic;
+            // Null for bind-only options, whose semantic writes the
+            // default itself.
+            std::shared_ptr<const Default_value> value;
+        };
+
+        unsigned long generation;
+        std::vector<entry> entries;
+    };
+
+}}
+
+#endif
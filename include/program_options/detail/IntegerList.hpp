@@ -0,0 +1,36 @@
+#ifndef INTEGERLIST_H
+#define INTEGERLIST_H
+
+#include <type_traits>
+#include <vector>
+
+namespace options { namespace detail {
+
+    /** Element types parsed by parse_integer_list; char and bool keep
+        their own textual conversions. */
+    template<class T>
+    struct is_integer_list_element
+    {
+        enum { value = std::is_integral<T>::value &&
+                       !std::is_same<T, bool>::value &&
+                       !std::is_same<T, char>::value &&
+                       !std::is_same<T, wchar_t>::value &&
+                       !std::is_same<T, char16_t>::value &&
+                       !std::is_same<T, char32_t>::value };
+    };
+
+    /** Appends the decimal integers of a 'delimiter' separated list in
+        [first, last) to 'out'. Delimiters are located with AVX2 or SSE2
+        when the CPU has them, the exact number of fields is reserved up
+        front and each field is converted in place, so no per element
+        string is ever built. Returns false on an empty field, a
+        character that is not a digit or a leading sign, or a value out
+        of range for T; 'out' may then hold a partial result.
+    */
+    template<class T>
+    bool parse_integer_list(const char* first, const char* last,
+                            char delimiter, std::vector<T>& out);
+
+}}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "program_options/Errors.hpp"
+
+namespace options { namespace detail {
+
+    /** Receives a JSON document as a stream of events. Strings passed
+        to key() and scalar() are only valid during the call. */
+    struct Json_handler
+    {
+        enum scalar_kind { string_value, number_value, boolean_value, null_value };
+
+        virtual ~Json_handler() {}
+
+        virtual void start_object() = 0;
+        virtual void end_object() = 0;
+        virtual void start_array() = 0;
+        virtual void end_array() = 0;
+        virtual void key(const std::string& name) = 0;
+        /** Strings come unescaped and UTF-8 encoded, numbers as written,
+            booleans as "true" or "false", null as "null". */
+        virtual void scalar(const std::string& text, scalar_kind kind) = 0;
+    };
+
+    /** A SAX-style JSON parser: it reads the stream a block at a time
+        and keeps no more than the nesting of the current value and the
+        current string, however large the document. Nesting is tracked
+        on the heap, so deep documents cannot overflow the stack. */
+    class Json_reader
+    {
+    public:
+        explicit Json_reader(std::istream& is);
+
+        /** Parses one JSON value followed by nothing but white space.
+            On malformed input, returns false and fills 'error' with an
+            invalid_syntax error whose token_index is the byte offset. */
+        bool parse(Json_handler& handler, Parse_error& error);
+
+    private:
+        int peek();
+        int get();
+        bool fill();
+        void skip_space();
+
+        bool read_string(std::string& out);
+        bool read_number(std::string& out);
+        bool read_literal(const char* word);
+        bool read_hex4(unsigned& cp);
+
+        bool fail(Parse_error& error, const char* what);
+
+        std::istream& m_is;
+        std::vector<char> m_buffer;
+        std::size_t m_pos, m_end;
+        // Bytes consumed before m_buffer[0].
+        std::size_t m_consumed;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef NAMETABLE_H
+#define NAMETABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bits.hpp"
+
+namespace options { namespace detail {
+
+    /* Option names are interned once, process-wide, into small dense
+       ids, so that per-name state can be kept in bitsets. Interning
+       takes a lock; it happens when options are registered, not when
+       they are parsed. */
+    unsigned name_id(const std::string& name);
+
+    /* The name 'id' was interned from. */
+    std::string id_name(unsigned id);
+
+    /* A set of name ids. */
+    class Id_set
+    {
+    public:
+        bool test(unsigned id) const
+        {
+            std::size_t w = id / 64;
+            return w < m_words.size() && (m_words[w] >> (id % 64) & 1);
+        }
+
+        void set(unsigned id)
+        {
+            std::size_t w = id / 64;
+            if (w >= m_words.size())
+                m_words.resize(w + 1);
+            m_words[w] |= uint64_t(1) << (id % 64);
+        }
+
+        void reset(unsigned id)
+        {
+            std::size_t w = id / 64;
+            if (w < m_words.size())
+                m_words[w] &= ~(uint64_t(1) << (id % 64));
+        }
+
+        /* Bits id % 64 of the ids with id / 64 == i. */
+        uint64_t word(std::size_t i) const
+        {
+            return i < m_words.size() ? m_words[i] : 0;
+        }
+
+        /* Keeps the words allocated, for sets that are refilled. */
+        void clear() { std::fill(m_words.begin(), m_words.end(), uint64_t(0)); }
+
+        bool empty() const
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+                if (m_words[i])
+                    return false;
+            return true;
+        }
+
+        Id_set& operator|=(const Id_set& other)
+        {
+            if (m_words.size() < other.m_words.size())
+                m_words.resize(other.m_words.size());
+            for (std::size_t i = 0; i < other.m_words.size(); ++i)
+                m_words[i] |= other.m_words[i];
+            return *this;
+        }
+
+        /* Calls f(id) for each id in this set and not in 'other'. */
+        template<class F>
+        void for_each_missing(const Id_set& other, F f) const
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+            {
+                uint64_t w = m_words[i];
+                if (i < other.m_words.size())
+                    w &= ~other.m_words[i];
+                for (; w; w &= w - 1)
+                    f(static_cast<unsigned>(i * 64 + count_trailing_zeros(w)));
+            }
+        }
+
+    private:
+        std::vector<uint64_t> m_words;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace options { namespace detail {
+
+    /* Calls f(i) for every i in [0, n) on up to 'threads' threads, the
+       calling one among them, handing out the indices in order. If a
+       call throws, no further indices are handed out and the first
+       exception is rethrown once every thread is done. With one thread
+       or one index, nothing is started. */
+    void parallel_for(std::size_t n, unsigned threads,
+                      const std::function<void(std::size_t)>& f);
+
+    /* std::thread::hardware_concurrency(), or 1 when unknown. */
+    unsigned hardware_threads();
+
+}}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+#include <string>
+
+namespace options { namespace detail {
+
+    /** True if all 'size' bytes are 7-bit ASCII. */
+    bool is_ascii(const char* p, std::size_t size);
+
+    /** Decodes UTF-8 into a wide string (UTF-32 or UTF-16, following the
+        width of wchar_t). ASCII input is widened without decoding and
+        ASCII runs inside mixed input are copied 16 bytes at a time.
+        Malformed sequences become U+FFFD. */
+    std::wstring from_utf8(const std::string& s);
+
+    void from_utf8(const char* p, std::size_t size, std::wstring& out);
+
+    /** Encodes a wide string as UTF-8; invalid code points become U+FFFD. */
+    std::string to_utf8(const std::wstring& s);
+
+    void to_utf8(const wchar_t* p, std::size_t size, std::string& out);
+
+}}
+
+#endif
@@ -1,4 +1,10 @@
 #include "../Any.hpp"
+#include "Convert.hpp"
+#include "IntegerList.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
 
 namespace options { 
 
@@ -11,11 +17,13 @@ namespace options {
         std::string const& var = (m_value_name.empty() ? arg : m_value_name);
         if (!m_implicit_value.empty() && !m_implicit_value_as_text.empty()) {
             std::string msg = "[=" + var + "(=" + m_implicit_value_as_text + ")]";
-            if (!m_default_value.empty() && !m_default_value_as_text.empty())
+            if ((!m_default_value.empty() || m_default_callback) &&
+                !m_default_value_as_text.empty())
                 msg += " (=" + m_default_value_as_text + ")";
             return msg;
         }
-        else if (!m_default_value.empty() && !m_default_value_as_text.empty()) {
+        else if ((!m_default_value.empty() || m_default_callback) &&
+                 !m_default_value_as_text.empty()) {
             return var + " (=" + m_default_value_as_text + ")";
         } else {
             return var;
@@ -43,8 +51,9 @@ namespace options {
                   const std::vector< std::basic_string<charT> >& xs, 
                   T*, long)
     {
-        std::basic_string<charT> s(validators::get_single_string(xs));
-        v = s;
+        T x;
+        if (detail::convert(validators::get_single_string(xs), x))
+            v = std::move(x);
     }
 
     void validate(Any& v, 
@@ -52,12 +61,311 @@ namespace options {
                        bool*,
                        int);
 
+    void validate(Any& v, 
+                       const std::vector<std::string>& xs, 
+                       std::string*,
+                       int);
+
+    void validate(Any& v, 
+                       const std::vector<std::wstring>& xs, 
+                       std::wstring*,
+                       int);
+
+    namespace detail {
+
+        /* Grows geometrically even when every occurrence of a composing
+           option reserves for its own few tokens. */
+        template<class T>
+        void reserve_more(std::vector<T>& v, std::size_t n)
+        {
+            if (v.capacity() - v.size() < n)
+                v.reserve((std::max)(v.size() + n, 2 * v.capacity()));
+        }
+
+        template<class T, class charT>
+        bool append_converted(std::vector<T>& out,
+                              const std::vector< std::basic_string<charT> >& s,
+                              std::true_type)
+        {
+            for (std::size_t i = 0; i < s.size(); ++i)
+            {
+                T x;
+                if (!convert(s[i], x))
+                    return false;
+                out.push_back(std::move(x));
+            }
+            return true;
+        }
+
+        /* User types keep going through their own validate() overload,
+           one element at a time. */
+        template<class T, class charT>
+        bool append_converted(std::vector<T>& out,
+                              const std::vector< std::basic_string<charT> >& s,
+                              std::false_type)
+        {
+            std::vector< std::basic_string<charT> > one(1);
+            for (std::size_t i = 0; i < s.size(); ++i)
+            {
+                Any a;
+                one[0] = s[i];
+                validate(a, one, (T*)0, 0);
+                T* x = any_cast<T>(&a);
+                if (!x)
+                    return false;
+                out.push_back(std::move(*x));
+            }
+            return true;
+        }
+    }
+
+    /* Appends all tokens to the vector already stored in 'v', so that
+       composing options accumulate across occurrences. If any token is
+       invalid the stored value is left as it was. */
     template<class T, class charT>
     void validate(Any& v, 
                   const std::vector<std::basic_string<charT> >& s, 
                   std::vector<T>*,
                   int)
     {
+        bool was_empty = v.empty();
+        if (was_empty)
+            v = std::vector<T>();
+        std::vector<T>* tv = any_cast< std::vector<T> >(&v);
+        assert(tv);
+
+        std::size_t old_size = tv->size();
+        detail::reserve_more(*tv, s.size());
+        typedef std::integral_constant<bool,
+            detail::is_direct_convertible<T>::value> direct;
+        if (!detail::append_converted(*tv, s, direct()))
+        {
+            if (was_empty)
+                v = Any();
+            else
+                tv->resize(old_size);
+        }
+    }
+
+    /* Delimited lists only make sense for vectors; anything else is
+       validated as if no delimiter had been set. */
+    template<class T, class charT>
+    void validate_delimited(Any& v, 
+                            const std::vector<std::basic_string<charT> >& xs,
+                            charT,
+                            T*, long)
+    {
+        validate(v, xs, (T*)0, 0);
+    }
+
+    namespace detail {
+
+        template<class T>
+        bool append_delimited(std::vector<T>& out, const std::string& s,
+                              char delimiter, std::true_type)
+        {
+            return parse_integer_list(s.data(), s.data() + s.size(),
+                                      delimiter, out);
+        }
+
+        template<class T>
+        bool append_delimited(std::vector<T>& out, const std::string& s,
+                              char delimiter, std::false_type)
+        {
+            std::vector<std::string> fields;
+            std::string::size_type begin = 0;
+            for (;;)
+            {
+                std::string::size_type end = s.find(delimiter, begin);
+                fields.push_back(s.substr(begin, end - begin));
+                if (end == std::string::npos)
+                    break;
+                begin = end + 1;
+            }
+            reserve_more(out, fields.size());
+            typedef std::integral_constant<bool,
+                is_direct_convertible<T>::value> direct;
+            return append_converted(out, fields, direct());
+        }
+
+        template<class T>
+        bool append_delimited(std::vector<T>& out, const std::wstring& s,
+                              wchar_t delimiter, std::false_type)
+        {
+            std::vector<std::wstring> fields;
+            std::wstring::size_type begin = 0;
+            for (;;)
+            {
+                std::wstring::size_type end = s.find(delimiter, begin);
+                fields.push_back(s.substr(begin, end - begin));
+                if (end == std::wstring::npos)
+                    break;
+                begin = end + 1;
+            }
+            reserve_more(out, fields.size());
+            typedef std::integral_constant<bool,
+                is_direct_convertible<T>::value> direct;
+            return append_converted(out, fields, direct());
+        }
+
+        /* An ASCII delimiter stays a single byte in UTF-8, so wide
+           integer lists are narrowed once and take the same kernel. */
+        template<class T>
+        bool append_delimited(std::vector<T>& out, const std::wstring& s,
+                              wchar_t delimiter, std::true_type integers)
+        {
+            if (static_cast<unsigned long>(delimiter) < 0x80)
+                return append_delimited(out, to_utf8(s),
+                                        static_cast<char>(delimiter), integers);
+            return append_delimited(out, s, delimiter, std::false_type());
+        }
+    }
+
+    template<class T, class charT>
+    void validate_delimited(Any& v, 
+                            const std::vector<std::basic_string<charT> >& xs,
+                            charT delimiter,
+                            std::vector<T>*, int)
+    {
+        bool was_empty = v.empty();
+        if (was_empty)
+            v = std::vector<T>();
+        std::vector<T>* tv = any_cast< std::vector<T> >(&v);
+        assert(tv);
+
+        std::size_t old_size = tv->size();
+        typedef std::integral_constant<bool,
+            detail::is_integer_list_element<T>::value> integers;
+        for (std::size_t i = 0; i < xs.size(); ++i)
+        {
+            if (xs[i].empty())
+                continue;
+            if (!detail::append_delimited(*tv, xs[i], delimiter, integers()))
+            {
+                if (was_empty)
+                    v = Any();
+                else
+                    tv->resize(old_size);
+                return;
+            }
+        }
+    }
+
+    namespace detail {
+
+        template<class T, class charT>
+        void validate_any(Any& v,
+                          const std::vector<std::basic_string<charT> >& xs,
+                          charT delimiter, T*)
+        {
+            if (delimiter)
+                validate_delimited(v, xs, delimiter, (T*)0, 0);
+            else
+                validate(v, xs, (T*)0, 0);
+        }
+
+        /* validate() only fails by leaving the value alone, so a single
+           value is validated into a fresh Any and kept if one appeared. */
+        template<class T, class charT>
+        bool validate_checked(Any& v,
+                              const std::vector<std::basic_string<charT> >& xs,
+                              charT delimiter, T*, long)
+        {
+            Any fresh;
+            validate_any(fresh, xs, delimiter, (T*)0);
+            if (fresh.empty())
+                return false;
+            v = std::move(fresh);
+            return true;
+        }
+
+        /* A vector must gain one element per token, or at least one per
+           non-empty token when each token holds a delimited list. */
+        template<class T, class charT>
+        bool validate_checked(Any& v,
+                              const std::vector<std::basic_string<charT> >& xs,
+                              charT delimiter, std::vector<T>*, int)
+        {
+            const std::vector<T>* tv = any_cast< std::vector<T> >(&v);
+            std::size_t before = tv ? tv->size() : 0;
+            validate_any(v, xs, delimiter, (std::vector<T>*)0);
+            tv = any_cast< std::vector<T> >(&v);
+            if (!tv)
+                return false;
+            if (!delimiter)
+                return tv->size() == before + xs.size();
+            if (tv->size() > before)
+                return true;
+            for (std::size_t i = 0; i < xs.size(); ++i)
+                if (!xs[i].empty())
+                    return false;
+            return true;
+        }
+    }
+
+    namespace detail {
+
+        inline const std::vector<std::string>&
+        tokens_as(const std::vector<std::string>& tokens, char)
+        {
+            return tokens;
+        }
+
+        std::vector<std::wstring>
+        tokens_as(const std::vector<std::string>& tokens, wchar_t);
+
+        /* The bind_tokens() family converts straight into a bound
+           variable and leaves it as it was when the tokens are invalid. */
+        template<class T, class charT>
+        bool bind_tokens(T& target,
+                         const std::vector<std::basic_string<charT> >& xs,
+                         charT, bool, std::true_type)
+        {
+            return convert(validators::get_single_string(xs), target);
+        }
+
+        template<class T, class charT>
+        bool bind_tokens(T& target,
+                         const std::vector<std::basic_string<charT> >& xs,
+                         charT delimiter, bool, std::false_type)
+        {
+            Any a;
+            validate_any(a, xs, delimiter, (T*)0);
+            T* x = any_cast<T>(&a);
+            if (!x)
+                return false;
+            target = std::move(*x);
+            return true;
+        }
+
+        template<class T, class charT>
+        bool bind_tokens(std::vector<T>& target,
+                         const std::vector<std::basic_string<charT> >& xs,
+                         charT delimiter, bool first, std::false_type)
+        {
+            if (first)
+                target.clear();
+            std::size_t before = target.size();
+            bool valid = true;
+            if (delimiter)
+            {
+                typedef std::integral_constant<bool,
+                    is_integer_list_element<T>::value> integers;
+                for (std::size_t i = 0; valid && i < xs.size(); ++i)
+                    valid = xs[i].empty() ||
+                        append_delimited(target, xs[i], delimiter, integers());
+            }
+            else
+            {
+                reserve_more(target, xs.size());
+                typedef std::integral_constant<bool,
+                    is_direct_convertible<T>::value> direct;
+                valid = append_converted(target, xs, direct());
+            }
+            if (!valid)
+                target.erase(target.begin() + before, target.end());
+            return valid;
+        }
     }
 
     template<class T, class charT>
@@ -68,10 +376,69 @@ namespace options {
     {
         if (new_tokens.empty() && !m_implicit_value.empty())
             value_store = m_implicit_value;
+        else if (m_delimiter)
+            validate_delimited(value_store, new_tokens, m_delimiter, (T*)0, 0);
         else
             validate(value_store, new_tokens, (T*)0, 0);
     }
 
+    template<class T, class charT>
+    bool
+    typed_value<T, charT>::
+    xparse_checked(Any& value_store,
+                   const std::vector<std::basic_string<charT> >& new_tokens) const
+    {
+        if (new_tokens.empty() && !m_implicit_value.empty())
+        {
+            value_store = m_implicit_value;
+            return true;
+        }
+        return detail::validate_checked(value_store, new_tokens, m_delimiter,
+                                        (T*)0, 0);
+    }
+
+    template<class T, class charT>
+    bool
+    typed_value<T, charT>::
+    parse_bound(const std::vector<std::string>& new_tokens, bool first) const
+    {
+        if (new_tokens.empty() && !m_implicit_value.empty())
+        {
+            *m_store_to = *any_cast<T>(&m_implicit_value);
+            return true;
+        }
+        typedef std::integral_constant<bool,
+            detail::is_direct_convertible<T>::value> direct;
+        return detail::bind_tokens(*m_store_to,
+                                   detail::tokens_as(new_tokens, charT()),
+                                   m_delimiter, first, direct());
+    }
+
+    template<class T, class charT>
+    bool
+    typed_value<T, charT>::apply_default_bound() const
+    {
+        if (m_default_callback) {
+            Any computed = m_default_callback();
+            *m_store_to = *any_cast<T>(&computed);
+            return true;
+        }
+        const T* value = any_cast<T>(&m_default_value);
+        if (!value)
+            return false;
+        *m_store_to = *value;
+        return true;
+    }
+
+    template<class T, class charT>
+    void
+    typed_value<T, charT>::notify(const Any& value_store) const
+    {
+        const T* value = any_cast<T>(&value_store);
+        if (m_store_to && value)
+            *m_store_to = *value;
+    }
+
     template<class T>
     typed_value<T>*
     value()
@@ -0,0 +1,98 @@
+#include "program_options/detail/BuiltinValue.hpp"
+#include "program_options/ValueSemantic.hpp"
+
+#include <iterator>
+
+namespace options { namespace detail {
+
+    namespace {
+
+        /* The same validate() overloads typed_value<T> reaches, called
+           directly. */
+        template<class T>
+        bool parse_as(Any& v, const std::vector<std::string>& tokens, bool checked)
+        {
+            if (checked)
+                return validate_checked(v, tokens, char(0), (T*)0, 0);
+            validate(v, tokens, (T*)0, 0);
+            return true;
+        }
+
+        template<class T>
+        void append_as(Any& to, Any& from)
+        {
+            if (to.empty())
+            {
+                to = std::move(from);
+                return;
+            }
+            std::vector<T>& xs = any_cast< std::vector<T> >(to);
+            std::vector<T>& ys = any_cast< std::vector<T> >(from);
+            xs.insert(xs.end(), std::make_move_iterator(ys.begin()),
+                      std::make_move_iterator(ys.end()));
+        }
+    }
+
+    bool
+    parse_builtin(int kind, Any& value_store,
+                  const std::vector<std::string>& tokens, bool checked)
+    {
+        switch (kind)
+        {
+        case bool_kind:
+            return parse_as<bool>(value_store, tokens, checked);
+        case int_kind:
+            return parse_as<int>(value_store, tokens, checked);
+        case unsigned_kind:
+            return parse_as<unsigned>(value_store, tokens, checked);
+        case long_kind:
+            return parse_as<long>(value_store, tokens, checked);
+        case unsigned_long_kind:
+            return parse_as<unsigned long>(value_store, tokens, checked);
+        case long_long_kind:
+            return parse_as<long long>(value_store, tokens, checked);
+        case unsigned_long_long_kind:
+            return parse_as<unsigned long long>(value_store, tokens, checked);
+        case float_kind:
+            return parse_as<float>(value_store, tokens, checked);
+        case double_kind:
+            return parse_as<double>(value_store, tokens, checked);
+        case string_kind:
+            return parse_as<std::string>(value_store, tokens, checked);
+        case int_vector_kind:
+            return parse_as< std::vector<int> >(value_store, tokens, checked);
+        case unsigned_vector_kind:
+            return parse_as< std::vector<unsigned> >(value_store, tokens, checked);
+        case long_vector_kind:
+            return parse_as< std::vector<long> >(value_store, tokens, checked);
+        case long_long_vector_kind:
+            return parse_as< std::vector<long long> >(value_store, tokens, checked);
+        case double_vector_kind:
+            return parse_as< std::vector<double> >(value_store, tokens, checked);
+        case string_vector_kind:
+            return parse_as< std::vector<std::string> >(value_store, tokens, checked);
+        }
+        return false;
+    }
+
+    void
+    append_builtin(int kind, Any& to, Any& from)
+    {
+        switch (kind)
+        {
+        case int_vector_kind:
+            return append_as<int>(to, from);
+        case unsigned_vector_kind:
+            return append_as<unsigned>(to, from);
+        case long_vector_kind:
+            return append_as<long>(to, from);
+        case long_long_vector_kind:
+            return append_as<long long>(to, from);
+        case double_vector_kind:
+            return append_as<double>(to, from);
+        case string_vector_kind:
+            return append_as<std::string>(to, from);
+        }
+    }
+
+}}
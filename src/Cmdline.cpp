@@ -2,6 +2,8 @@
 #include "program_options/OptionsDescription.hpp"
 #include "program_options/PositionalOptions.hpp"
 #include "program_options/ValueSemantic.hpp"
+#include "program_options/ParseObserver.hpp"
+#include "program_options/Parsers.hpp"
 
 #include <string>
 #include <utility>
@@ -18,18 +20,23 @@ namespace options { namespace detail {
 
     Cmdline::Cmdline(const vector<string>& args)
     {
-        init(args);
+        init(TokenBuffer(args));
     }
 
     Cmdline::Cmdline(int argc, const char** argv)
     {
-        init(vector<string>(argv+1, argv+argc+!argc));
+        init(TokenBuffer(argc ? argc-1 : 0, argv+1));
+    }
+
+    Cmdline::Cmdline(TokenBuffer args)
+    {
+        init(std::move(args));
     }
 
     void
-    Cmdline::init(const vector<string>& args)
+    Cmdline::init(TokenBuffer args)
     {
-        this->args = args;        
+        this->args = std::move(args);
         m_desc = 0;
         m_allow_unregistered = false;
     }
@@ -45,213 +52,228 @@ namespace options { namespace detail {
     {
         m_desc = &desc;
     }
-    typedef std::vector<Option> (options::detail::Cmdline::* style_parser)(const std::string&);
-
-      
-
-    vector<Option>
-    Cmdline::run()
+    void
+    Cmdline::run(ParsedOptions& result, Parse_error* error)
     {
     	assert(m_desc);
 
-    	style_parser style_parsers[] = {&Cmdline::parse_long_option, &Cmdline::parse_short_option};
+    	ParseObserver* observer = detail::observer();
 
-    	vector<Option> result;
-    	while(!args.empty())
+    	// First, split every token into options and positional arguments.
+    	m_items.clear();
+    	string token;
+    	for (unsigned current = 0; current < args.size(); ++current)
     	{
-    		bool unkonwn = false;
-    		for(auto parser : style_parsers)
-    		{
-    			unsigned current_size = static_cast<unsigned>(args.size());
-    			vector<Option> next = (this->*parser)(args[0]);
+    		const char* tok = args.token(current);
+    		std::size_t length = args.length(current);
+    		ParseObserver::token_kind kind;
 
-    			if(!next.empty())
-    			{
-    				for(auto var : next)
-    				{
-    					//var.dump();
-    					result.push_back(var);
-    				}
-    				args.erase(args.begin());
-    			}
-    			if (args.size() < current_size) {
-    				unkonwn = true;
-    				break;
-    			}
+    		if (length >= 3 && tok[0] == '-' && tok[1] == '-')
+    		{
+    			classify_long(current);
+    			kind = ParseObserver::long_option;
+    		}
+    		else if (length >= 2 && tok[0] == '-' && tok[1] != '-')
+    		{
+    			classify_short(current);
+    			kind = ParseObserver::short_option;
+    		}
+    		else
+    		{
+    			item it = item();
+    			it.value = tok;
+    			it.value_length = length;
+    			it.token = current;
+    			it.first = true;
+    			m_items.push_back(it);
+    			kind = ParseObserver::positional;
     		}
 
-    		if (!unkonwn) {
-    			Option opt;
-    			opt.value.push_back(args[0]);
-    			opt.original_tokens.push_back(args[0]);
-    			result.push_back(opt);
-    			args.erase(args.begin());
+    		if (observer)
+    		{
+    			token.assign(tok, length);
+    			observer->token_classified(current, token, kind, now());
     		}
     	}
-    	//        for(auto var : result)
-    	//        {
-    	//        	var.dump();
-    	//        }
-    	vector<Option> result2;
-    	for (unsigned i = 0; i < result.size(); ++i)
-    	{
-    		result2.push_back(result[i]);
-    		Option& opt = result2.back();
 
-    		if (opt.string_key.empty())
+    	// Then resolve the names; an option that can take more tokens
+    	// absorbs the positional arguments that follow it.
+    	int position_key = 0;
+    	for (std::size_t i = 0; i < m_items.size(); ++i)
+    	{
+    		const item& it = m_items[i];
+    		if (it.positional())
     		{
+    			append(result, it, 0, position_key++);
     			continue;
     		}
 
-    		const OptionDescription* xd = m_desc->find_nothrow(opt.string_key,
-    				true,
-					true,
-					true);
-
-    		if (!xd)
+    		if (it.letter)
     		{
-    			opt.unregistered = true;
-    			result2.pop_back();
-    			continue;
+    			m_name.assign(1, '-');
+    			m_name += it.letter;
     		}
-    		unsigned min_tokens = xd->semantic()->min_tokens();
-    		unsigned max_tokens = xd->semantic()->max_tokens();
-    		if (min_tokens < max_tokens && opt.value.size() < max_tokens)
+    		else
     		{
-    			int can_take_more = max_tokens - static_cast<int>(opt.value.size());
-    			unsigned j = i+1;
-    			for (; can_take_more && j < result.size(); --can_take_more, ++j)
-    			{
-    				Option& opt2 = result[j];
-    				if (!opt2.string_key.empty())
-    					break;
+    			m_name.assign(it.key, it.key_length);
+    		}
 
-    				if (opt2.position_key == INT_MAX)
-    				{
-    					break;
-    				}
+    		Parse_error ambiguity;
+    		const OptionDescription* xd = m_desc->find_nothrow(m_name,
+    				true,
+					true,
+					true,
+					&ambiguity);
 
-    				assert(opt2.value.size() == 1);
+    		if (ambiguity)
+    		{
+    			ambiguity.token_index = static_cast<int>(it.token);
+    			if (!error)
+    				throw Options_error(ambiguity);
+    			*error = std::move(ambiguity);
+    			return;
+    		}
 
-    				opt.value.push_back(opt2.value[0]);
+    		if (observer)
+    			observer->option_matched(m_name, xd, now());
 
-    				assert(opt2.original_tokens.size() == 1);
+    		if (!xd)
+    			continue;
 
-    				opt.original_tokens.push_back(opt2.original_tokens[0]);
+    		std::size_t j = i + 1;
+    		unsigned min_tokens = xd->min_tokens();
+    		unsigned max_tokens = xd->max_tokens();
+    		unsigned has = it.value ? 1 : 0;
+    		if (min_tokens < max_tokens && has < max_tokens)
+    		{
+    			unsigned can_take_more = max_tokens - has;
+    			for (; can_take_more && j < m_items.size() &&
+    					m_items[j].positional() && m_items[j].value;
+    					--can_take_more, ++j)
+    			{
     			}
-    			i = j-1;
     		}
+    		append(result, it, j - i - 1, -1);
+    		i = j - 1;
     	}
-    	result.swap(result2);
+    }
+
+    /* Writes 'it' and the 'absorbed' positional items after it as one
+       option. */
+    void
+    Cmdline::append(ParsedOptions& result, const item& it,
+                    std::size_t absorbed, int position_key)
+    {
+    	TokenBuffer& out = result.tokens;
+    	ParsedOptions::entry e;
+    	e.first = static_cast<unsigned>(out.size());
 
-		int position_key = 0;
-    	for(unsigned i = 0; i < result.size(); ++i) {
-    		if (result[i].string_key.empty())
-    			result[i].position_key = position_key++;
+    	if (it.letter)
+    	{
+    		out.append('-');
+    		out.append(it.letter);
+    		out.finish();
+    	}
+    	else
+    	{
+    		out.push_back(it.key ? it.key : "", it.key_length);
     	}
 
-		for (unsigned i = 0; i < result.size(); ++i) {
-			if (result[i].string_key.size() > 2 ||
-					(result[i].string_key.size() > 1 && result[i].string_key[0] != '-'))
-			{
-				result[i].case_insensitive = true;//is_style_active(long_case_insensitive);
-			}
-			else
-			{
-				result[i].case_insensitive = true ;//is_style_active(short_case_insensitive);
-			}
-		}
-
-		for(auto var: result)
-		{
-			//var.dump();
-		}
-		return result;
+    	const item* next = &it + 1;
+    	if (it.value)
+    		out.push_back(it.value, it.value_length);
+    	for (std::size_t k = 0; k < absorbed; ++k)
+    		out.push_back(next[k].value, next[k].value_length);
+    	e.values = static_cast<unsigned>((it.value ? 1 : 0) + absorbed);
+
+    	if (it.first)
+    		out.push_back(args.token(it.token), args.length(it.token));
+    	for (std::size_t k = 0; k < absorbed; ++k)
+    		out.push_back(args.token(next[k].token), args.length(next[k].token));
+    	e.originals = static_cast<unsigned>((it.first ? 1 : 0) + absorbed);
+
+    	e.position_key = position_key;
+    	e.token_index = static_cast<int>(it.token);
+    	e.case_insensitive = true;
+    	e.has_value = it.has_value;
+    	result.entries.push_back(e);
     }
 
-    vector<Option> 
-    Cmdline::parse_long_option(const string& tok)
+    /* '--name' or '--name=value'; an empty value counts as none. */
+    void
+    Cmdline::classify_long(unsigned token)
     {
-        vector<Option> result;
+        const char* tok = args.token(token);
+        std::size_t length = args.length(token);
+        const char* eq = static_cast<const char*>(
+            std::memchr(tok + 2, '=', length - 2));
+
+        item it = item();
+        it.key = tok + 2;
+        it.key_length = (eq ? eq : tok + length) - it.key;
+        if (eq && eq + 1 < tok + length)
+        {
+            it.value = eq + 1;
+            it.value_length = tok + length - it.value;
+            it.has_value = true;
+        }
+        it.token = token;
+        it.first = true;
+        m_items.push_back(it);
+    }
 
-        if (tok.size() >= 3 && tok[0] == '-' && tok[1] == '-')
-        {   
-            string name, adjacent;
-            string::size_type p = tok.find('=');
-            if (p != tok.npos)
+    /* '-abc' is '-a -b -c' for as long as the letters are known
+       options; what is left after the last known one is its value, as
+       is anything after '='. */
+    void
+    Cmdline::classify_short(unsigned token)
+    {
+        const char* tok = args.token(token);
+        std::size_t length = args.length(token);
+
+        m_name.assign(tok, 2);
+        // Start of what follows 'm_name' in 'tok'.
+        std::size_t adjacent = 2;
+        bool first = true;
+
+        for(;;) {
+            const OptionDescription* d = m_desc->find_nothrow(m_name, false, false, true);
+
+            item it = item();
+            it.token = token;
+            it.first = first;
+            first = false;
+            if (d)
             {
-                name = tok.substr(2, p-2);
-                adjacent = tok.substr(p+1);
+                it.key = d->long_name().data();
+                it.key_length = d->long_name().size();
             }
             else
             {
-                name = tok.substr(2);
+                it.letter = m_name[1];
             }
-            Option opt;
-            opt.string_key = name;
-            if (!adjacent.empty())
+
+            if (d && adjacent < length && tok[adjacent] != '=')
             {
-                opt.value.push_back(adjacent);
-                opt.hasValue = true;
+                // 'adjacent' is in fact further option.
+                m_items.push_back(it);
+                m_name[1] = tok[adjacent++];
+                continue;
             }
-            opt.original_tokens.push_back(tok);
-            result.push_back(opt);
-        }
-        return result;
-    }
-
 
-    vector<Option> 
-    Cmdline::parse_short_option(const string& tok)
-    {
-        if (tok.size() >= 2 && tok[0] == '-' && tok[1] != '-')
-        {   
-            vector<Option> result;
-
-            string name = tok.substr(0,2);
-            string adjacent = tok.substr(2);
-
-            for(;;) {
-                const OptionDescription* d = m_desc->find_nothrow(name, false, false, true);
-
-                if(d && !adjacent.empty()){
-                    // 'adjacent' is in fact further option.
-                    Option opt;
-                    opt.string_key = d->long_name();
-                    opt.original_tokens.push_back(tok);
-                    if(adjacent[0] == '=')
-                    {
-                    	adjacent.erase(adjacent.begin());
-                    	opt.value.push_back(adjacent);
-                    	result.push_back(opt);
-                    	return result;
-                    }
-                    result.push_back(opt);
-                    
-                    if (adjacent.empty())
-                    {
-                        break;
-                    }
-
-                    name = string("-") + adjacent[0];
-                    adjacent.erase(adjacent.begin());
-                }
-                else
-                {
-                    
-                    Option opt;
-                    opt.string_key = d?d->long_name():name;
-                    opt.original_tokens.push_back(tok);
-                    if (!adjacent.empty())
-                        opt.value.push_back(adjacent);
-                    result.push_back(opt);
-
-                    break;
-                }
+            if (d && adjacent < length)
+            {
+                it.value = tok + adjacent + 1;
+                it.value_length = length - adjacent - 1;
+            }
+            else if (adjacent < length)
+            {
+                it.value = tok + adjacent;
+                it.value_length = length - adjacent;
             }
-            return result;
+            m_items.push_back(it);
+            return;
         }
-        return vector<Option>();
     }
 
 }}
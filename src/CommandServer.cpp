@@ -0,0 +1,193 @@
+#include "program_options/CommandServer.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace options {
+
+    namespace {
+
+        const std::size_t block_size = 64 * 1024;
+
+        long read_some(int fd, char* p, std::size_t n)
+        {
+#ifdef _WIN32
+            return ::_read(fd, p, static_cast<unsigned>(n));
+#else
+            return static_cast<long>(::read(fd, p, n));
+#endif
+        }
+
+        /* Empties 'm' for the next line but keeps its entries, and so
+           their nodes and keys, with no value; store() takes them over
+           like defaults. */
+        void recycle(VariablesMap& m)
+        {
+            for (auto& e : m)
+            {
+                e.second = VariableValue();
+                e.second.defaulted = true;
+            }
+            m.m_final.clear();
+            m.m_required.clear();
+            m.m_present.clear();
+            m.m_defaulted.clear();
+            m.m_wildcard_ids.clear();
+            m.m_wildcard_final.clear();
+            m.m_wildcard_present.clear();
+            m.m_wildcard_defaulted.clear();
+            m.touch();
+        }
+
+        // Drops the entries the line left without a value.
+        void drop_empty(VariablesMap& m)
+        {
+            for (VariablesMap::iterator i = m.begin(); i != m.end(); )
+            {
+                if (i->second.empty())
+                    i = m.erase(i);
+                else
+                    ++i;
+            }
+        }
+    }
+
+    CommandServer::CommandServer(const OptionsDescription& desc, char delimiter,
+                                 std::size_t max_line)
+    : m_cmdline(TokenBuffer())
+    , m_parsed(&desc)
+    , m_buffer(block_size)
+    , m_delimiter(delimiter)
+    , m_max_line(max_line)
+    {
+        m_cmdline.set_options_description(desc);
+    }
+
+    std::size_t
+    CommandServer::serve(int fd, const handler& h)
+    {
+        std::size_t lines = 0;
+        m_line.clear();
+        // Whether the current line went past m_max_line; the rest of it
+        // is skipped.
+        bool overlong = false;
+
+        // Runs the handler on m_line, unless it is blank.
+        auto finish_line = [&]() -> bool {
+            if (overlong)
+            {
+                overlong = false;
+                ++lines;
+                return serve_overlong(h);
+            }
+            if (m_delimiter == '\n' && !m_line.empty() && *m_line.rbegin() == '\r')
+                m_line.erase(m_line.size() - 1);
+            if (m_line.empty())
+                return true;
+            ++lines;
+            return serve_line(h);
+        };
+
+        // Appends [p, q) to m_line, or skips it once the line is too long.
+        auto append = [&](const char* p, const char* q) {
+            if (overlong)
+                return;
+            if (static_cast<std::size_t>(q - p) > m_max_line - m_line.size())
+            {
+                overlong = true;
+                m_line.clear();
+            }
+            else
+                m_line.append(p, q);
+        };
+
+        for (;;)
+        {
+            long n = read_some(fd, m_buffer.data(), m_buffer.size());
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(),
+                                        "CommandServer::serve");
+            }
+            if (n == 0)
+                break;
+
+            const char* p = m_buffer.data();
+            const char* e = p + n;
+            while (p != e)
+            {
+                const char* q = static_cast<const char*>(
+                    std::memchr(p, m_delimiter, e - p));
+                if (!q)
+                {
+                    append(p, e);
+                    break;
+                }
+                append(p, q);
+                p = q + 1;
+                if (!finish_line())
+                    return lines;
+                m_line.clear();
+            }
+        }
+
+        // The last line need not be terminated.
+        finish_line();
+        return lines;
+    }
+
+    bool
+    CommandServer::serve_line(const char* line, std::size_t size, const handler& h)
+    {
+        if (size > m_max_line)
+            return serve_overlong(h);
+        m_line.assign(line, size);
+        return serve_line(h);
+    }
+
+    bool
+    CommandServer::serve_line(const handler& h)
+    {
+        TokenBuffer& tokens = m_cmdline.tokens();
+        tokens.clear();
+        split_unix(m_line, tokens);
+
+        m_error = Parse_error();
+        recycle(m_map);
+        m_parsed.clear();
+        m_cmdline.run(m_parsed, &m_error);
+        if (!m_error)
+        {
+            Expected<void> stored = try_store(m_parsed, m_map);
+            drop_empty(m_map);
+            if (stored)
+                stored = try_check_constraints(m_map, *m_parsed.description);
+            if (!stored)
+                m_error = stored.error();
+        }
+        else
+            drop_empty(m_map);
+        return h(m_map, m_error);
+    }
+
+    bool
+    CommandServer::serve_overlong(const handler& h)
+    {
+        m_error = Parse_error(Parse_error::invalid_syntax, -1,
+                              "line longer than " + std::to_string(m_max_line) +
+                              " bytes");
+        recycle(m_map);
+        drop_empty(m_map);
+        return h(m_map, m_error);
+    }
+
+}
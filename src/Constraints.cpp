@@ -0,0 +1,157 @@
+#include "program_options/detail/Constraints.hpp"
+#include "program_options/detail/Bits.hpp"
+
+#include <algorithm>
+
+namespace options { namespace detail {
+
+    void
+    Constraints::add(kind_type kind, const std::vector<std::string>& names,
+                     const std::string& subject)
+    {
+        rule r;
+        r.kind = kind;
+        r.subject = kind == depends ? name_id(subject) : 0;
+
+        // A name given twice counts once.
+        r.id_begin = m_ids.size();
+        for (const auto& name : names)
+        {
+            unsigned id = name_id(name);
+            if (std::find(m_ids.begin() + r.id_begin, m_ids.end(), id) == m_ids.end())
+                m_ids.push_back(id);
+        }
+        r.id_end = m_ids.size();
+
+        std::vector<unsigned> sorted(m_ids.begin() + r.id_begin, m_ids.end());
+        std::sort(sorted.begin(), sorted.end());
+        r.mask_begin = m_masks.size();
+        for (unsigned id : sorted)
+        {
+            if (m_masks.size() == r.mask_begin || m_masks.back().first != id / 64)
+                m_masks.push_back(std::make_pair(std::size_t(id / 64), uint64_t(0)));
+            m_masks.back().second |= uint64_t(1) << (id % 64);
+        }
+        r.mask_end = m_masks.size();
+        m_rules.push_back(r);
+    }
+
+    void
+    Constraints::add(const Constraints& other)
+    {
+        const std::size_t masks = m_masks.size(), ids = m_ids.size();
+        for (rule r : other.m_rules)
+        {
+            r.mask_begin += masks;
+            r.mask_end += masks;
+            r.id_begin += ids;
+            r.id_end += ids;
+            m_rules.push_back(r);
+        }
+        m_masks.insert(m_masks.end(), other.m_masks.begin(), other.m_masks.end());
+        m_ids.insert(m_ids.end(), other.m_ids.begin(), other.m_ids.end());
+    }
+
+    bool
+    Constraints::known(const rule& r, const Id_set& keys, Parse_error& error) const
+    {
+        unsigned unknown = 0;
+        bool found = r.kind == depends && !keys.test(r.subject);
+        if (found)
+            unknown = r.subject;
+        for (std::size_t m = r.mask_begin; m < r.mask_end && !found; ++m)
+        {
+            const std::size_t w = m_masks[m].first;
+            if (m_masks[m].second & ~keys.word(w))
+                for (std::size_t i = r.id_begin; i < r.id_end && !found; ++i)
+                    if (m_ids[i] / 64 == w && !keys.test(m_ids[i]))
+                    {
+                        unknown = m_ids[i];
+                        found = true;
+                    }
+        }
+        if (!found)
+            return true;
+        error = Parse_error(Parse_error::unknown_rule_option, -1, id_name(unknown));
+        return false;
+    }
+
+    bool
+    Constraints::check(const Id_set& keys, const Id_set& present,
+                       const Id_set& defaulted, Parse_error& error) const
+    {
+        // A misspelt name is reported whatever was given.
+        for (const rule& r : m_rules)
+            if (!known(r, keys, error))
+                return false;
+
+        for (const rule& r : m_rules)
+        {
+            unsigned given = 0;
+            for (std::size_t m = r.mask_begin; m < r.mask_end; ++m)
+            {
+                const std::size_t w = m_masks[m].first;
+                given += popcount(present.word(w) & ~defaulted.word(w)
+                                  & m_masks[m].second);
+            }
+
+            bool broken = false;
+            switch (r.kind)
+            {
+            case conflicts:
+                broken = given > 1;
+                break;
+            case one_of:
+                broken = given != 1;
+                break;
+            case at_least_one:
+                broken = given == 0;
+                break;
+            case depends:
+                broken = given < r.id_end - r.id_begin &&
+                         present.test(r.subject) && !defaulted.test(r.subject);
+                break;
+            }
+            if (broken)
+            {
+                fail(r, given, present, defaulted, error);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void
+    Constraints::fail(const rule& r, unsigned given, const Id_set& present,
+                      const Id_set& defaulted, Parse_error& error) const
+    {
+        if (r.kind == depends)
+        {
+            error = Parse_error(Parse_error::missing_dependency, -1, std::string());
+            error.option = id_name(r.subject);
+            for (std::size_t i = r.id_begin; i < r.id_end; ++i)
+                if (!present.test(m_ids[i]) || defaulted.test(m_ids[i]))
+                {
+                    error.token = id_name(m_ids[i]);
+                    break;
+                }
+            return;
+        }
+
+        if (given == 0)
+        {
+            error = Parse_error(Parse_error::missing_one_of, -1, std::string());
+            for (std::size_t i = r.id_begin; i < r.id_end; ++i)
+                error.candidates.push_back(id_name(m_ids[i]));
+            return;
+        }
+
+        error = Parse_error(Parse_error::conflicting_options, -1, std::string());
+        for (std::size_t i = r.id_begin; i < r.id_end; ++i)
+            if (present.test(m_ids[i]) && !defaulted.test(m_ids[i]))
+                error.candidates.push_back(id_name(m_ids[i]));
+        error.option = error.candidates.back();
+        error.token = error.option;
+    }
+
+}}
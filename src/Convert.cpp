@@ -0,0 +1,106 @@
+#include "program_options/detail/Convert.hpp"
+
+#include <cctype>
+#include <cstring>
+
+namespace options { namespace detail {
+
+    namespace {
+
+        bool iequals(const char* first, const char* last, const char* word)
+        {
+            size_t n = std::strlen(word);
+            if (static_cast<size_t>(last - first) != n)
+                return false;
+            for (size_t i = 0; i < n; ++i)
+                if (std::tolower(static_cast<unsigned char>(first[i])) != word[i])
+                    return false;
+            return true;
+        }
+
+        // strto* need a terminated buffer; tokens are short, so copy them
+        // to the stack instead of allocating.
+        template<class F>
+        bool with_terminated(const char* first, const char* last, F f)
+        {
+            char buffer[64];
+            size_t n = static_cast<size_t>(last - first);
+            if (n == 0 || n >= sizeof(buffer))
+                return n != 0 && f(std::string(first, last).c_str(), n);
+            std::memcpy(buffer, first, n);
+            buffer[n] = 0;
+            return f(buffer, n);
+        }
+    }
+
+    bool convert(const char* first, const char* last, bool& out)
+    {
+        if (first == last || iequals(first, last, "on") ||
+            iequals(first, last, "yes") || iequals(first, last, "1") ||
+            iequals(first, last, "true"))
+            out = true;
+        else if (iequals(first, last, "off") || iequals(first, last, "no") ||
+                 iequals(first, last, "0") || iequals(first, last, "false"))
+            out = false;
+        else
+            return false;
+        return true;
+    }
+
+    bool convert(const char* first, const char* last, char& out)
+    {
+        if (last - first != 1)
+            return false;
+        out = *first;
+        return true;
+    }
+
+    bool parse_signed(const char* first, const char* last,
+                      long long min, long long max, long long& out)
+    {
+        return with_terminated(first, last, [&](const char* s, size_t n) {
+            if (std::isspace(static_cast<unsigned char>(s[0])))
+                return false;
+            char* end;
+            errno = 0;
+            long long x = std::strtoll(s, &end, 10);
+            if (errno || end != s + n || x < min || x > max)
+                return false;
+            out = x;
+            return true;
+        });
+    }
+
+    bool parse_unsigned(const char* first, const char* last,
+                        unsigned long long max, unsigned long long& out)
+    {
+        return with_terminated(first, last, [&](const char* s, size_t n) {
+            // strtoull silently negates "-1"
+            if (s[0] == '-' || std::isspace(static_cast<unsigned char>(s[0])))
+                return false;
+            char* end;
+            errno = 0;
+            unsigned long long x = std::strtoull(s, &end, 10);
+            if (errno || end != s + n || x > max)
+                return false;
+            out = x;
+            return true;
+        });
+    }
+
+    bool parse_floating(const char* first, const char* last, long double& out)
+    {
+        return with_terminated(first, last, [&](const char* s, size_t n) {
+            if (std::isspace(static_cast<unsigned char>(s[0])))
+                return false;
+            char* end;
+            errno = 0;
+            long double x = std::strtold(s, &end);
+            if (errno == ERANGE || end != s + n)
+                return false;
+            out = x;
+            return true;
+        });
+    }
+
+}}
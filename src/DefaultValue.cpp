@@ -0,0 +1,32 @@
+#include "program_options/detail/DefaultValue.hpp"
+
+namespace options { namespace detail {
+
+    Default_value::Default_value(Any value)
+    : m_value(std::move(value)), m_ready(true)
+    {
+    }
+
+    Default_value::Default_value(std::function<Any()> compute)
+    : m_compute(std::move(compute)), m_ready(false)
+    {
+    }
+
+    const Any&
+    Default_value::get() const
+    {
+        if (!m_ready)
+            std::call_once(m_once, [this] {
+                m_value = m_compute();
+                m_ready = true;
+            });
+        return m_value;
+    }
+
+    bool
+    Default_value::pending() const
+    {
+        return !m_ready;
+    }
+
+}}
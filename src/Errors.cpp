@@ -0,0 +1,73 @@
+#include "program_options/Errors.hpp"
+
+namespace options {
+
+    namespace {
+
+        /* 'a', 'b' <last> 'c' */
+        std::string quoted_list(const std::vector<std::string>& names,
+                                const char* last)
+        {
+            std::string result;
+            for (std::size_t i = 0; i < names.size(); ++i)
+            {
+                if (i)
+                    result += i + 1 == names.size() ? last : ", ";
+                result += "'" + names[i] + "'";
+            }
+            return result;
+        }
+    }
+
+    std::string
+    Parse_error::message() const
+    {
+        std::string result;
+        switch (kind)
+        {
+        case none:
+            return result;
+        case ambiguous_option:
+            result = "option '" + token + "' is ambiguous";
+            for (std::size_t i = 0; i < candidates.size(); ++i)
+                result += (i ? ", '" : " and matches '") + candidates[i] + "'";
+            break;
+        case invalid_value:
+            result = "the argument '" + token + "' is invalid";
+            if (!option.empty())
+                result += " for option '" + option + "'";
+            break;
+        case invalid_syntax:
+            result = "syntax error: " + token;
+            if (token_index >= 0)
+                result += " at byte " + std::to_string(token_index);
+            if (!file.empty())
+                result += " of '" + file + "'";
+            return result;
+        case unreadable_file:
+            result = "cannot read config file '" + token + "'";
+            if (!file.empty())
+                result += " included from '" + file + "'";
+            return result;
+        case include_cycle:
+            return "config file '" + token + "' includes itself through '" +
+                   file + "'";
+        case conflicting_options:
+            result = "the options " + quoted_list(candidates, " and ") +
+                     " cannot be used together";
+            break;
+        case missing_dependency:
+            result = "option '" + option + "' requires option '" + token + "'";
+            break;
+        case missing_one_of:
+            return "one of the options " + quoted_list(candidates, " or ") +
+                   " is required";
+        case unknown_rule_option:
+            return "a rule names '" + token + "', which is not an option";
+        }
+        if (token_index >= 0)
+            result += " (token " + std::to_string(token_index) + ")";
+        return result;
+    }
+
+}
@@ -0,0 +1,280 @@
+#include "program_options/detail/IntegerList.hpp"
+#include "program_options/detail/Bits.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define OPTIONS_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace options { namespace detail {
+
+    namespace {
+
+        /* Bit i of 'delims' is set if p[i] is the delimiter, bit i of
+           'others' if p[i] is neither the delimiter nor a digit.
+           Each classifier looks at exactly 64 bytes. */
+        typedef void (*classify_fn)(const char* p, char delimiter,
+                                    uint64_t& delims, uint64_t& others);
+
+        void classify_scalar(const char* p, char delimiter,
+                             uint64_t& delims, uint64_t& others)
+        {
+            delims = others = 0;
+            for (unsigned i = 0; i < 64; ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(p[i]);
+                if (c == static_cast<unsigned char>(delimiter))
+                    delims |= uint64_t(1) << i;
+                else if (static_cast<unsigned>(c - '0') > 9u)
+                    others |= uint64_t(1) << i;
+            }
+        }
+
+#ifdef OPTIONS_X86_DISPATCH
+        __attribute__((target("sse2")))
+        void classify_sse2(const char* p, char delimiter,
+                           uint64_t& delims, uint64_t& others)
+        {
+            const __m128i d = _mm_set1_epi8(delimiter);
+            const __m128i zero = _mm_set1_epi8('0');
+            const __m128i nine = _mm_set1_epi8(9);
+            delims = others = 0;
+            for (unsigned i = 0; i < 64; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                __m128i digit = _mm_sub_epi8(x, zero);
+                // unsigned digit <= 9  <=>  min(digit, 9) == digit
+                __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, nine), digit);
+                __m128i is_delim = _mm_cmpeq_epi8(x, d);
+                uint64_t dm = static_cast<unsigned>(_mm_movemask_epi8(is_delim));
+                uint64_t ok = static_cast<unsigned>(
+                    _mm_movemask_epi8(_mm_or_si128(is_digit, is_delim)));
+                delims |= dm << i;
+                others |= (~ok & 0xffff) << i;
+            }
+        }
+
+        __attribute__((target("avx2")))
+        void classify_avx2(const char* p, char delimiter,
+                           uint64_t& delims, uint64_t& others)
+        {
+            const __m256i d = _mm256_set1_epi8(delimiter);
+            const __m256i zero = _mm256_set1_epi8('0');
+            const __m256i nine = _mm256_set1_epi8(9);
+            delims = others = 0;
+            for (unsigned i = 0; i < 64; i += 32)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                __m256i digit = _mm256_sub_epi8(x, zero);
+                __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, nine), digit);
+                __m256i is_delim = _mm256_cmpeq_epi8(x, d);
+                uint64_t dm = static_cast<uint32_t>(_mm256_movemask_epi8(is_delim));
+                uint64_t ok = static_cast<uint32_t>(
+                    _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_delim)));
+                delims |= dm << i;
+                others |= (~ok & 0xffffffffu) << i;
+            }
+        }
+#endif
+
+        classify_fn select_classifier()
+        {
+#ifdef OPTIONS_X86_DISPATCH
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return classify_avx2;
+            if (__builtin_cpu_supports("sse2"))
+                return classify_sse2;
+#endif
+            return classify_scalar;
+        }
+
+        const classify_fn classify = select_classifier();
+
+        bool little_endian()
+        {
+            const uint16_t one = 1;
+            unsigned char c;
+            std::memcpy(&c, &one, 1);
+            return c == 1;
+        }
+
+        const bool swar_ok = little_endian();
+
+        /* Eight ASCII digits to their value with three multiplications. */
+        uint32_t parse_eight_digits(const char* p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            v -= 0x3030303030303030ULL;
+            v = (v * 10) + (v >> 8);
+            v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                 (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+            return static_cast<uint32_t>(v);
+        }
+
+        /* Digits only, already checked by the classifier. */
+        bool parse_magnitude(const char* p, const char* e, uint64_t& out)
+        {
+            size_t n = static_cast<size_t>(e - p);
+            if (n == 0)
+                return false;
+            while (n > 1 && *p == '0')
+            {
+                ++p;
+                --n;
+            }
+            if (n > 20)
+                return false;
+
+            uint64_t v = 0;
+            if (n > 19)
+            {
+                // Only the 20 digit case can overflow 64 bits.
+                for (; p != e; ++p)
+                {
+                    uint64_t digit = static_cast<uint64_t>(*p - '0');
+                    if (v > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+                        return false;
+                    v = v * 10 + digit;
+                }
+                out = v;
+                return true;
+            }
+            if (swar_ok)
+                for (; n >= 8; n -= 8, p += 8)
+                    v = v * 100000000ULL + parse_eight_digits(p);
+            for (; p != e; ++p)
+                v = v * 10 + static_cast<uint64_t>(*p - '0');
+            out = v;
+            return true;
+        }
+
+        template<class T>
+        bool parse_field(const char* b, const char* e, std::vector<T>& out)
+        {
+            bool negative = false;
+            if (b != e && static_cast<unsigned>(static_cast<unsigned char>(*b) - '0') > 9u)
+            {
+                if (*b == '-')
+                    negative = true;
+                else if (*b != '+')
+                    return false;
+                ++b;
+            }
+
+            uint64_t magnitude;
+            if (!parse_magnitude(b, e, magnitude))
+                return false;
+
+            if (negative)
+            {
+                if (!std::numeric_limits<T>::is_signed)
+                    return false;
+                uint64_t limit = static_cast<uint64_t>(
+                    -(std::numeric_limits<T>::min() + 1)) + 1;
+                if (magnitude > limit)
+                    return false;
+                out.push_back(static_cast<T>(
+                    -static_cast<int64_t>(magnitude - 1) - 1));
+            }
+            else
+            {
+                if (magnitude > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+                    return false;
+                out.push_back(static_cast<T>(magnitude));
+            }
+            return true;
+        }
+
+        /* Runs 'f(offset, delims, others)' over 64 byte blocks, the last
+           one copied to a padded buffer and masked to the real length. */
+        template<class F>
+        void for_each_block(const char* first, const char* last,
+                            char delimiter, F f)
+        {
+            size_t size = static_cast<size_t>(last - first);
+            size_t offset = 0;
+            uint64_t delims, others;
+            for (; offset + 64 <= size; offset += 64)
+            {
+                classify(first + offset, delimiter, delims, others);
+                f(offset, delims, others);
+            }
+            if (offset < size)
+            {
+                char tail[64];
+                size_t n = size - offset;
+                std::memcpy(tail, first + offset, n);
+                std::memset(tail + n, '0', 64 - n);
+                classify(tail, delimiter, delims, others);
+                uint64_t valid = (uint64_t(1) << n) - 1;
+                f(offset, delims & valid, others & valid);
+            }
+        }
+    }
+
+    template<class T>
+    bool parse_integer_list(const char* first, const char* last,
+                            char delimiter, std::vector<T>& out)
+    {
+        if (first == last)
+            return true;
+
+        // First pass: count the fields, so the vector grows once, and
+        // reject any character other than a digit that does not start a
+        // field. Whether such a character is a sign is left to
+        // parse_field.
+        size_t fields = 1;
+        uint64_t carry = 1;
+        bool bad = false;
+        for_each_block(first, last, delimiter,
+                       [&](size_t, uint64_t delims, uint64_t others) {
+                           uint64_t starts = (delims << 1) | carry;
+                           carry = delims >> 63;
+                           bad = bad || (others & ~starts) != 0;
+                           fields += popcount(delims);
+                       });
+        if (bad)
+            return false;
+        if (out.capacity() - out.size() < fields)
+            out.reserve(out.size() + fields);
+
+        // Second pass: walk the delimiter bits and convert each field.
+        bool ok = true;
+        size_t begin = 0;
+        for_each_block(first, last, delimiter,
+                       [&](size_t offset, uint64_t delims, uint64_t) {
+                           for (; ok && delims; delims &= delims - 1)
+                           {
+                               size_t end = offset + count_trailing_zeros(delims);
+                               ok = parse_field(first + begin, first + end, out);
+                               begin = end + 1;
+                           }
+                       });
+        return ok && parse_field(first + begin, last, out);
+    }
+
+#define OPTIONS_INSTANTIATE_INTEGER_LIST(T) \
+    template bool parse_integer_list<T>(const char*, const char*, char, \
+                                        std::vector<T>&);
+
+    OPTIONS_INSTANTIATE_INTEGER_LIST(signed char)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(unsigned char)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(short)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(unsigned short)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(int)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(unsigned int)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(long)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(unsigned long)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(long long)
+    OPTIONS_INSTANTIATE_INTEGER_LIST(unsigned long long)
+
+#undef OPTIONS_INSTANTIATE_INTEGER_LIST
+
+}}
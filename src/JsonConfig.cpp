@@ -0,0 +1,422 @@
+#include "program_options/Parsers.hpp"
+#include "program_options/OptionsDescription.hpp"
+#include "program_options/ValueSemantic.hpp"
+#include "program_options/ParseObserver.hpp"
+#include "program_options/detail/JsonReader.hpp"
+#include "program_options/detail/Parallel.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#define OPTIONS_HAVE_GLOB
+#elif defined(__unix__) || defined(__APPLE__)
+#include <glob.h>
+#define OPTIONS_HAVE_GLOB
+#endif
+
+namespace options {
+
+    namespace {
+
+        /* A top-level "include" member of a config file: its patterns,
+           and how many options came before it. */
+        struct include_point
+        {
+            include_point(std::size_t xposition, std::vector<std::string>& xpatterns)
+            : position(xposition) { patterns.swap(xpatterns); }
+
+            std::size_t position;
+            std::vector<std::string> patterns;
+        };
+
+        /* Turns reader events into options as they arrive. The only
+           state is the dotted path to the current member and, for each
+           array being collected, its option and values so far. */
+        class Option_builder : public detail::Json_handler
+        {
+        public:
+            Option_builder(const OptionsDescription& desc,
+                           ParsedOptions& out,
+                           std::vector<include_point>* includes = 0)
+            : m_desc(desc), m_out(out), m_includes(includes) {}
+
+            void start_object()
+            {
+                m_frames.push_back(frame(false, m_path.size()));
+            }
+
+            void end_object()
+            {
+                m_path.resize(m_frames.back().base);
+                m_frames.pop_back();
+            }
+
+            void start_array()
+            {
+                // Nested arrays add to the option of the outermost one.
+                if (!in_array())
+                    m_pending.push_back(pending(m_path));
+                m_frames.push_back(frame(true, m_path.size()));
+            }
+
+            void end_array()
+            {
+                m_frames.pop_back();
+                if (!in_array()) {
+                    emit(m_pending.back().name, m_pending.back().values);
+                    m_pending.pop_back();
+                }
+            }
+
+            void key(const std::string& name)
+            {
+                m_path.resize(m_frames.back().base);
+                if (!m_path.empty())
+                    m_path += '.';
+                m_path += name;
+            }
+
+            void scalar(const std::string& text, scalar_kind kind)
+            {
+                if (in_array()) {
+                    if (kind != null_value)
+                        m_pending.back().values.push_back(text);
+                    return;
+                }
+                std::vector<std::string> values;
+                if (kind != null_value)
+                    values.push_back(text);
+                emit(m_path, values);
+            }
+
+        private:
+            struct frame {
+                frame(bool xarray, std::size_t xbase) : array(xarray), base(xbase) {}
+                bool array;
+                std::size_t base;
+            };
+
+            struct pending {
+                explicit pending(const std::string& xname) : name(xname) {}
+                std::string name;
+                std::vector<std::string> values;
+            };
+
+            bool in_array() const
+            {
+                return !m_frames.empty() && m_frames.back().array;
+            }
+
+            /* Names the description does not know are dropped here, as
+               the command line parser drops them. A flag takes true as
+               given and false as absent. */
+            void emit(const std::string& name, std::vector<std::string>& values)
+            {
+                if (name.empty())
+                    return;
+                if (m_includes && name == "include") {
+                    m_includes->push_back(include_point(m_out.size(), values));
+                    return;
+                }
+                const OptionDescription* d = m_desc.find_nothrow(name, false);
+                if (!d)
+                    return;
+                if (d->max_tokens() == 0 && values.size() == 1) {
+                    if (values[0] == "false")
+                        return;
+                    if (values[0] == "true")
+                        values.clear();
+                }
+
+                ParsedOptions::entry e;
+                e.first = static_cast<unsigned>(m_out.tokens.size());
+                e.values = static_cast<unsigned>(values.size());
+                e.has_value = !values.empty();
+                m_out.tokens.push_back(name);
+                for (const auto& v : values)
+                    m_out.tokens.push_back(v);
+                m_out.entries.push_back(e);
+            }
+
+            const OptionsDescription& m_desc;
+            ParsedOptions& m_out;
+            std::vector<include_point>* m_includes;
+            std::string m_path;
+            std::vector<frame> m_frames;
+            std::vector<pending> m_pending;
+        };
+
+        /* A config file as parse_config_file() found it; 'parent' is
+           the file that included it. */
+        struct config_file
+        {
+            config_file(const std::string& xpath, std::size_t xparent)
+            : path(xpath), parent(xparent), options(0) {}
+
+            std::string path;
+            std::string canonical;
+            std::size_t parent;
+            ParsedOptions options;
+            std::vector<include_point> includes;
+            // The files each include point expanded to, in order.
+            std::vector< std::vector<std::size_t> > children;
+            Parse_error error;
+            ParseObserver::time_point start, end;
+        };
+
+        const std::size_t no_parent = std::size_t(-1);
+
+        /* The absolute name of the existing file 'path', with links
+           resolved where the platform can. Without either, the name as
+           given, so that a cycle is still found once it comes back to
+           the same spelling. */
+        bool canonical_name(const std::string& path, std::string& out)
+        {
+#if defined(_WIN32)
+            char resolved[_MAX_PATH];
+            if (!_fullpath(resolved, path.c_str(), _MAX_PATH) ||
+                GetFileAttributesA(resolved) == INVALID_FILE_ATTRIBUTES)
+                return false;
+            out = resolved;
+            // Names differing in case are the same file.
+            for (auto& c : out)
+                if (c >= 'A' && c <= 'Z')
+                    c = char(c - 'A' + 'a');
+#elif defined(__unix__) || defined(__APPLE__)
+            char resolved[PATH_MAX];
+            if (!realpath(path.c_str(), resolved))
+                return false;
+            out = resolved;
+#else
+            out = path;
+#endif
+            return true;
+        }
+
+#ifdef OPTIONS_HAVE_GLOB
+        /* Appends the files matching 'name', in byte order. */
+        void glob_files(const std::string& name, std::vector<std::string>& out)
+        {
+            std::vector<std::string> names;
+#if defined(_WIN32)
+            // Wildcards are only honoured in the last component.
+            const std::string::size_type slash = name.find_last_of("/\\");
+            const std::string dir =
+                slash == std::string::npos ? std::string() : name.substr(0, slash + 1);
+            WIN32_FIND_DATAA found;
+            HANDLE h = FindFirstFileA(name.c_str(), &found);
+            if (h != INVALID_HANDLE_VALUE)
+            {
+                do
+                    if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+                        names.push_back(dir + found.cFileName);
+                while (FindNextFileA(h, &found));
+                FindClose(h);
+            }
+#else
+            glob_t found;
+            if (glob(name.c_str(), 0, 0, &found) == 0)
+                names.assign(found.gl_pathv, found.gl_pathv + found.gl_pathc);
+            globfree(&found);
+#endif
+            std::sort(names.begin(), names.end());
+            out.insert(out.end(), names.begin(), names.end());
+        }
+#endif
+
+        /* Reads file 'k' unless it is one of its own includers, whose
+           canonical names are known by then. */
+        void load(std::vector<config_file>& files, std::size_t k,
+                  const OptionsDescription& desc, bool timed)
+        {
+            config_file& f = files[k];
+            if (timed)
+                f.start = detail::now();
+
+            const std::string includer =
+                f.parent == no_parent ? std::string() : files[f.parent].path;
+            std::ifstream in;
+            if (canonical_name(f.path, f.canonical))
+                in.open(f.path.c_str(), std::ios_base::in | std::ios_base::binary);
+            if (!in.is_open())
+            {
+                f.error = Parse_error(Parse_error::unreadable_file, -1, f.path);
+                f.error.file = includer;
+                return;
+            }
+
+            for (std::size_t p = f.parent; p != no_parent; p = files[p].parent)
+                if (files[p].canonical == f.canonical)
+                {
+                    f.error = Parse_error(Parse_error::include_cycle, -1, f.path);
+                    f.error.file = includer;
+                    return;
+                }
+
+            f.options.description = &desc;
+            Option_builder builder(desc, f.options, &f.includes);
+            if (!detail::Json_reader(in).parse(builder, f.error))
+                f.error.file = f.path;
+            if (timed)
+                f.end = detail::now();
+        }
+
+        /* Appends the files 'pattern' names, relative to the directory
+           of 'from', in byte order. A name without wildcards is kept
+           whether it exists or not, so that reading it reports it; so
+           is one with wildcards where the platform cannot expand them. */
+        void expand(const std::string& from, const std::string& pattern,
+                    std::vector<std::string>& out)
+        {
+#if defined(_WIN32)
+            const char* separators = "/\\";
+            const bool absolute = !pattern.empty() &&
+                (pattern.find_first_of(separators) == 0 ||
+                 (pattern.size() > 1 && pattern[1] == ':'));
+#else
+            const char* separators = "/";
+            const bool absolute = !pattern.empty() && pattern[0] == '/';
+#endif
+            std::string name = pattern;
+            std::string::size_type slash = from.find_last_of(separators);
+            if (slash != std::string::npos && !absolute)
+                name = from.substr(0, slash + 1) + name;
+
+#ifdef OPTIONS_HAVE_GLOB
+            if (name.find_first_of("*?[") != std::string::npos)
+            {
+                glob_files(name, out);
+                return;
+            }
+#endif
+            out.push_back(name);
+        }
+
+        void append_options(ParsedOptions& out, const ParsedOptions& in,
+                            std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                ParsedOptions::entry e = in.entries[i];
+                const std::size_t n = 1 + e.values + e.originals;
+                e.first = static_cast<unsigned>(out.tokens.size());
+                for (std::size_t t = 0; t < n; ++t)
+                    out.tokens.push_back(in.tokens.token(in.entries[i].first + t),
+                                         in.tokens.length(in.entries[i].first + t));
+                out.entries.push_back(e);
+            }
+        }
+
+        /* Appends the options of file 'k' with those of its includes in
+           their place, stopping at the first error. */
+        bool assemble(const std::vector<config_file>& files, std::size_t k,
+                      ParsedOptions& out, Parse_error& error,
+                      ParseObserver* observer)
+        {
+            const config_file& f = files[k];
+            if (f.error)
+            {
+                error = f.error;
+                return false;
+            }
+            if (observer)
+                observer->file_loaded(f.path, f.start, f.end);
+
+            std::size_t done = 0;
+            for (std::size_t p = 0; p < f.includes.size(); ++p)
+            {
+                append_options(out, f.options, done, f.includes[p].position);
+                done = f.includes[p].position;
+                for (std::size_t child : f.children[p])
+                    if (!assemble(files, child, out, error, observer))
+                        return false;
+            }
+            append_options(out, f.options, done, f.options.size());
+            return true;
+        }
+    }
+
+    ParsedOptions
+    parse_json_config(std::istream& is, const OptionsDescription& desc)
+    {
+        Expected<ParsedOptions> result = try_parse_json_config(is, desc);
+        if (!result)
+            throw Options_error(result.error());
+        return std::move(*result);
+    }
+
+    Expected<ParsedOptions>
+    try_parse_json_config(std::istream& is, const OptionsDescription& desc)
+    {
+        ParsedOptions result(&desc);
+        Option_builder builder(desc, result);
+        Parse_error error;
+        if (!detail::Json_reader(is).parse(builder, error))
+            return Expected<ParsedOptions>(std::move(error));
+        return Expected<ParsedOptions>(std::move(result));
+    }
+
+    ParsedOptions
+    parse_config_file(const std::string& path, const OptionsDescription& desc,
+                      unsigned threads)
+    {
+        Expected<ParsedOptions> result = try_parse_config_file(path, desc, threads);
+        if (!result)
+            throw Options_error(result.error());
+        return std::move(*result);
+    }
+
+    Expected<ParsedOptions>
+    try_parse_config_file(const std::string& path, const OptionsDescription& desc,
+                          unsigned threads)
+    {
+        if (!threads)
+            threads = detail::hardware_threads();
+        ParseObserver* observer = detail::observer();
+
+        // Read a level of includes at a time, all of its files at once.
+        std::vector<config_file> files;
+        files.push_back(config_file(path, no_parent));
+        std::vector<std::size_t> level(1, 0), next;
+        std::vector<std::string> names;
+        while (!level.empty())
+        {
+            detail::parallel_for(level.size(), threads, [&](std::size_t k) {
+                load(files, level[k], desc, observer != 0);
+            });
+
+            next.clear();
+            for (std::size_t k : level)
+            {
+                const std::size_t includes = files[k].includes.size();
+                files[k].children.resize(includes);
+                for (std::size_t p = 0; p < includes; ++p)
+                {
+                    names.clear();
+                    for (const auto& pattern : files[k].includes[p].patterns)
+                        expand(files[k].path, pattern, names);
+                    for (const auto& name : names)
+                    {
+                        files[k].children[p].push_back(files.size());
+                        next.push_back(files.size());
+                        files.push_back(config_file(name, k));
+                    }
+                }
+            }
+            level.swap(next);
+        }
+
+        ParsedOptions result(&desc);
+        Parse_error error;
+        if (!assemble(files, 0, result, error, observer))
+            return Expected<ParsedOptions>(std::move(error));
+        return Expected<ParsedOptions>(std::move(result));
+    }
+
+}
@@ -0,0 +1,327 @@
+#include "program_options/detail/JsonReader.hpp"
+
+#include <istream>
+
+namespace options { namespace detail {
+
+    namespace {
+
+        const std::size_t block_size = 64 * 1024;
+
+        void append_utf8(unsigned long cp, std::string& out)
+        {
+            if (cp < 0x80) {
+                out += static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        inline bool is_digit(int c) { return c >= '0' && c <= '9'; }
+    }
+
+    Json_reader::Json_reader(std::istream& is)
+    : m_is(is), m_buffer(block_size), m_pos(0), m_end(0), m_consumed(0)
+    {
+    }
+
+    bool
+    Json_reader::fill()
+    {
+        m_consumed += m_end;
+        m_pos = m_end = 0;
+        std::streambuf* sb = m_is.rdbuf();
+        if (!sb)
+            return false;
+        std::streamsize n = sb->sgetn(m_buffer.data(),
+                                      static_cast<std::streamsize>(m_buffer.size()));
+        if (n <= 0) {
+            m_is.setstate(std::ios_base::eofbit);
+            return false;
+        }
+        m_end = static_cast<std::size_t>(n);
+        return true;
+    }
+
+    int
+    Json_reader::peek()
+    {
+        if (m_pos == m_end && !fill())
+            return -1;
+        return static_cast<unsigned char>(m_buffer[m_pos]);
+    }
+
+    int
+    Json_reader::get()
+    {
+        int c = peek();
+        if (c >= 0)
+            ++m_pos;
+        return c;
+    }
+
+    void
+    Json_reader::skip_space()
+    {
+        for (;;) {
+            int c = peek();
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                return;
+            ++m_pos;
+        }
+    }
+
+    bool
+    Json_reader::read_hex4(unsigned& cp)
+    {
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            int c = get();
+            cp <<= 4;
+            if (is_digit(c))
+                cp |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                cp |= c - 'A' + 10;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    /* Expects the opening quote to be consumed already. Plain runs are
+       appended a buffer at a time; only escapes go byte by byte. */
+    bool
+    Json_reader::read_string(std::string& out)
+    {
+        out.clear();
+        for (;;) {
+            if (m_pos == m_end && !fill())
+                return false;
+
+            const char* p = m_buffer.data() + m_pos;
+            const char* e = m_buffer.data() + m_end;
+            const char* q = p;
+            while (q != e && *q != '"' && *q != '\\' &&
+                   static_cast<unsigned char>(*q) >= 0x20)
+                ++q;
+            out.append(p, q);
+            m_pos += q - p;
+            if (q == e)
+                continue;
+
+            int c = get();
+            if (c == '"')
+                return true;
+            if (c != '\\')
+                return false;
+
+            switch (get()) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                unsigned cp;
+                if (!read_hex4(cp))
+                    return false;
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    // A high surrogate must be followed by a low one.
+                    unsigned low;
+                    if (get() != '\\' || get() != 'u' || !read_hex4(low) ||
+                        low < 0xDC00 || low >= 0xE000)
+                        return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp < 0xE000) {
+                    return false;
+                }
+                append_utf8(cp, out);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+    }
+
+    /* -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? */
+    bool
+    Json_reader::read_number(std::string& out)
+    {
+        out.clear();
+        if (peek() == '-')
+            out += static_cast<char>(get());
+        if (peek() == '0') {
+            out += static_cast<char>(get());
+        } else if (is_digit(peek())) {
+            while (is_digit(peek()))
+                out += static_cast<char>(get());
+        } else {
+            return false;
+        }
+        if (peek() == '.') {
+            out += static_cast<char>(get());
+            if (!is_digit(peek()))
+                return false;
+            while (is_digit(peek()))
+                out += static_cast<char>(get());
+        }
+        if (peek() == 'e' || peek() == 'E') {
+            out += static_cast<char>(get());
+            if (peek() == '+' || peek() == '-')
+                out += static_cast<char>(get());
+            if (!is_digit(peek()))
+                return false;
+            while (is_digit(peek()))
+                out += static_cast<char>(get());
+        }
+        return true;
+    }
+
+    bool
+    Json_reader::read_literal(const char* word)
+    {
+        for (; *word; ++word)
+            if (get() != static_cast<unsigned char>(*word))
+                return false;
+        return true;
+    }
+
+    bool
+    Json_reader::fail(Parse_error& error, const char* what)
+    {
+        error = Parse_error(Parse_error::invalid_syntax,
+                            static_cast<int>(m_consumed + m_pos), what);
+        return false;
+    }
+
+    bool
+    Json_reader::parse(Json_handler& handler, Parse_error& error)
+    {
+        enum { value, first_key, key, first_value, after_value } state = value;
+        // '{' or '[' for each open container.
+        std::vector<char> open;
+        std::string text;
+
+        for (;;) {
+            skip_space();
+            int c = peek();
+
+            switch (state) {
+            case first_value:
+                if (c == ']') {
+                    ++m_pos;
+                    open.pop_back();
+                    handler.end_array();
+                    state = after_value;
+                    break;
+                }
+                // fall through
+            case value:
+                switch (c) {
+                case '{':
+                    ++m_pos;
+                    open.push_back('{');
+                    handler.start_object();
+                    state = first_key;
+                    continue;
+                case '[':
+                    ++m_pos;
+                    open.push_back('[');
+                    handler.start_array();
+                    state = first_value;
+                    continue;
+                case '"':
+                    ++m_pos;
+                    if (!read_string(text))
+                        return fail(error, "malformed string");
+                    handler.scalar(text, Json_handler::string_value);
+                    break;
+                case 't':
+                case 'f':
+                    if (!read_literal(c == 't' ? "true" : "false"))
+                        return fail(error, "unknown literal");
+                    text = c == 't' ? "true" : "false";
+                    handler.scalar(text, Json_handler::boolean_value);
+                    break;
+                case 'n':
+                    if (!read_literal("null"))
+                        return fail(error, "unknown literal");
+                    text = "null";
+                    handler.scalar(text, Json_handler::null_value);
+                    break;
+                default:
+                    if (c != '-' && !is_digit(c))
+                        return fail(error, "expected a value");
+                    if (!read_number(text))
+                        return fail(error, "malformed number");
+                    handler.scalar(text, Json_handler::number_value);
+                    break;
+                }
+                state = after_value;
+                break;
+
+            case first_key:
+                if (c == '}') {
+                    ++m_pos;
+                    open.pop_back();
+                    handler.end_object();
+                    state = after_value;
+                    break;
+                }
+                // fall through
+            case key:
+                if (c != '"')
+                    return fail(error, "expected a member name");
+                ++m_pos;
+                if (!read_string(text))
+                    return fail(error, "malformed string");
+                skip_space();
+                if (peek() != ':')
+                    return fail(error, "expected ':'");
+                ++m_pos;
+                handler.key(text);
+                state = value;
+                break;
+
+            case after_value:
+                if (open.empty()) {
+                    if (c >= 0)
+                        return fail(error, "trailing characters");
+                    return true;
+                }
+                if (c == ',') {
+                    ++m_pos;
+                    state = open.back() == '{' ? key : value;
+                } else if (c == (open.back() == '{' ? '}' : ']')) {
+                    ++m_pos;
+                    if (open.back() == '{')
+                        handler.end_object();
+                    else
+                        handler.end_array();
+                    open.pop_back();
+                } else {
+                    return fail(error, open.back() == '{'
+                                ? "expected ',' or '}'" : "expected ',' or ']'");
+                }
+                break;
+            }
+        }
+    }
+
+}}
@@ -0,0 +1,50 @@
+#include "program_options/detail/NameTable.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace options { namespace detail {
+
+    namespace {
+
+        struct name_table
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, unsigned> ids;
+            std::deque<std::string> names;
+        };
+
+        // Never destroyed, as descriptions in other statics may still
+        // register names during static destruction.
+        name_table& table()
+        {
+            static name_table* t = new name_table;
+            return *t;
+        }
+    }
+
+    unsigned
+    name_id(const std::string& name)
+    {
+        name_table& t = table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        std::unordered_map<std::string, unsigned>::const_iterator i =
+            t.ids.find(name);
+        if (i != t.ids.end())
+            return i->second;
+        unsigned id = static_cast<unsigned>(t.names.size());
+        t.names.push_back(name);
+        t.ids.emplace(name, id);
+        return id;
+    }
+
+    std::string
+    id_name(unsigned id)
+    {
+        name_table& t = table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        return id < t.names.size() ? t.names[id] : std::string();
+    }
+
+}}
@@ -5,9 +5,13 @@
 #include <climits>
 #include <cstring>
 #include <cstdarg>
+#include <cstdint>
+#include <new>
+#include <type_traits>
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 
 using namespace std;
@@ -16,21 +20,219 @@ namespace options {
 
    namespace {
 
-       template< class charT >
-       std::basic_string< charT >  tolower_(const std::basic_string< charT >& str)
+       /* Sets the 0x20 bit of the upper case ASCII letters among the
+          eight bytes of 'x'; other bytes, including non-ASCII ones, are
+          left alone. */
+       inline uint64_t fold_word(uint64_t x)
        {
-           std::basic_string< charT > result;
-           for (typename std::basic_string< charT >::size_type i = 0; i < str.size(); ++i)
-           {
-               result.append(1, static_cast< charT >(std::tolower(str[i])));
-           }   
+           const uint64_t high = 0x8080808080808080ULL;
+           const uint64_t low7 = x & ~high;
+           const uint64_t ge_a = low7 + 0x3f3f3f3f3f3f3f3fULL;  // >= 'A'
+           const uint64_t gt_z = low7 + 0x2525252525252525ULL;  // >  'Z'
+           const uint64_t upper = ge_a & ~gt_z & ~x & high;
+           return x | (upper >> 2);
+       }
+
+       inline char fold_char(char c)
+       {
+           return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+       }
+
+       std::string fold(const std::string& s)
+       {
+           std::string result(s);
+           for (std::string::size_type i = 0; i < result.size(); ++i)
+               result[i] = fold_char(result[i]);
            return result;
        }
 
+       /* Compares the first 'n' bytes of 'a', folded on the fly, with
+          the already folded 'folded', eight bytes at a time. */
+       bool folded_equal(const char* a, const char* folded, std::size_t n)
+       {
+           std::size_t i = 0;
+           for (; i + 8 <= n; i += 8)
+           {
+               uint64_t x, y;
+               std::memcpy(&x, a + i, 8);
+               std::memcpy(&y, folded + i, 8);
+               if (fold_word(x) != y)
+                   return false;
+           }
+           for (; i < n; ++i)
+               if (fold_char(a[i]) != folded[i])
+                   return false;
+           return true;
+       }
+
+       /* Bytes [offset, offset + 8) of 's', folded, packed low byte
+          first; 'mask' gets the bytes that were present. */
+       uint64_t fold_prefix(const std::string& s, std::size_t offset,
+                            uint64_t* mask = 0)
+       {
+           std::size_t n = s.size() > offset ? s.size() - offset : 0;
+           if (n > 8)
+               n = 8;
+           uint64_t word = 0;
+           for (std::size_t i = 0; i < n; ++i)
+               word |= uint64_t(static_cast<unsigned char>(
+                           fold_char(s[offset + i]))) << (8*i);
+           if (mask)
+               *mask = n == 8 ? ~uint64_t(0) : (uint64_t(1) << (8*n)) - 1;
+           return word;
+       }
+
+       /* Does 'option' start with the first 'n' bytes of 'name'? */
+       bool starts_with(const std::string& option, const std::string& name,
+                        const std::string& folded_name, std::size_t n,
+                        bool ignore_case)
+       {
+           if (option.size() < n)
+               return false;
+           if (ignore_case)
+               return folded_equal(option.data(), folded_name.data(), n);
+           return option.compare(0, n, name, 0, n) == 0;
+       }
+
+       bool equals(const std::string& option, const std::string& name,
+                   const std::string& folded_name, bool ignore_case)
+       {
+           return option.size() == name.size() &&
+               starts_with(option, name, folded_name, name.size(), ignore_case);
+       }
+
+       /* FNV-1a of the first 'n' bytes of 's', folded. */
+       uint32_t folded_hash(const char* s, std::size_t n)
+       {
+           uint32_t h = 2166136261u;
+           for (std::size_t i = 0; i < n; ++i)
+               h = (h ^ static_cast<unsigned char>(fold_char(s[i]))) * 16777619u;
+           return h;
+       }
+
+       /* Is 'name' the first 'n' bytes of 's', both folded? */
+       bool same_folded(const std::string& name, const char* s, std::size_t n)
+       {
+           if (name.size() != n)
+               return false;
+           for (std::size_t i = 0; i < n; ++i)
+               if (fold_char(name[i]) != fold_char(s[i]))
+                   return false;
+           return true;
+       }
+
+       /* Orders the folded 'folded' before, with or after the first 'n'
+          bytes of 's' folded, comparing bytes unsigned as std::string
+          does. */
+       int compare_folded(const std::string& folded, const char* s, std::size_t n)
+       {
+           const std::size_t m = std::min(folded.size(), n);
+           for (std::size_t i = 0; i < m; ++i)
+           {
+               const unsigned char a = static_cast<unsigned char>(folded[i]);
+               const unsigned char b = static_cast<unsigned char>(fold_char(s[i]));
+               if (a != b)
+                   return a < b ? -1 : 1;
+           }
+           return folded.size() < n ? -1 : folded.size() > n ? 1 : 0;
+       }
+
+       /* Does the folded 'folded' start with the first 'n' bytes of 's'
+          folded? */
+       bool starts_folded(const std::string& folded, const char* s, std::size_t n)
+       {
+           return folded.size() >= n && folded_equal(s, folded.data(), n);
+       }
+
+    }
+
+    namespace detail {
+
+        /* Owns the descriptions made by add_options() on one
+           OptionsDescription, so that each one costs a slot in a chunk
+           rather than its own allocation and shared_ptr control block.
+           Only that description adds to it; copies get their own.
+           Chunks double in size, up to 256 slots. The value semantics
+           live in a separate pool: a description points into it, and
+           must not keep the arena alive through it. */
+        struct Semantic_pool {
+            std::vector< std::unique_ptr<const Value_semantic> > semantics;
+        };
+
+        struct Description_arena {
+            typedef std::aligned_storage<sizeof(OptionDescription),
+                                         alignof(OptionDescription)>::type slot;
+
+            Description_arena()
+            : pool(std::make_shared<Semantic_pool>()), m_used(0), m_capacity(0)
+            {}
+
+            Description_arena(const Description_arena&) = delete;
+            Description_arena& operator=(const Description_arena&) = delete;
+
+            ~Description_arena()
+            {
+                for (std::size_t c = m_chunks.size(); c-- > 0; )
+                {
+                    std::size_t n = c + 1 == m_chunks.size()
+                        ? m_used : chunk_size(c);
+                    while (n-- > 0)
+                        reinterpret_cast<OptionDescription*>(
+                            &m_chunks[c][n])->~OptionDescription();
+                }
+            }
+
+            template<class... Args>
+            OptionDescription* emplace(Args&&... args)
+            {
+                if (m_used == m_capacity)
+                {
+                    m_capacity = chunk_size(m_chunks.size());
+                    m_chunks.emplace_back(new slot[m_capacity]);
+                    m_used = 0;
+                }
+                OptionDescription* d = new (&m_chunks.back()[m_used])
+                    OptionDescription(std::forward<Args>(args)...);
+                ++m_used;
+                return d;
+            }
+
+            std::shared_ptr<Semantic_pool> pool;
+
+        private:
+            static std::size_t chunk_size(std::size_t chunk)
+            {
+                return chunk < 5 ? std::size_t(16) << chunk : 256;
+            }
+
+            std::vector< std::unique_ptr<slot[]> > m_chunks;
+            std::size_t m_used, m_capacity;
+        };
+    }
+
+    namespace {
+
+        std::atomic<unsigned long> last_generation(0);
+
+        unsigned long next_generation()
+        {
+            return ++last_generation;
+        }
+
+        /* Description-only options all behave the same way, so they
+           share one semantic that nobody owns. */
+        std::shared_ptr<const Value_semantic> untyped_semantic()
+        {
+            static const Untyped_value untyped(true);
+            return std::shared_ptr<const Value_semantic>(
+                std::shared_ptr<const Value_semantic>(), &untyped);
+        }
     }
 
     OptionDescription::OptionDescription()
+    : m_id(detail::name_id(""))
     {
+        cache_semantic();
     }
     
     OptionDescription::
@@ -39,6 +241,7 @@ namespace options {
     : m_value_semantic(s)
     {
         this->set_name(name);
+        cache_semantic();
     }
                                            
 
@@ -49,6 +252,17 @@ namespace options {
     : m_description(description), m_value_semantic(s)
     {
         this->set_name(name);
+        cache_semantic();
+    }
+
+    OptionDescription::
+    OptionDescription(const char* name,
+                       std::shared_ptr<const Value_semantic> s,
+                       const char* description)
+    : m_description(description), m_value_semantic(std::move(s))
+    {
+        this->set_name(name);
+        cache_semantic();
     }
 
     OptionDescription::~OptionDescription()
@@ -63,28 +277,29 @@ namespace options {
     {
         match_result result = no_match;        
         
-        std::string local_long_name((long_ignore_case ? tolower_(m_long_name) : m_long_name));
+        if (!m_long_name.empty()) {
         
-        if (!local_long_name.empty()) {
-        
-            std::string local_option = (long_ignore_case ? tolower_(option) : option);
-
-            if (*local_long_name.rbegin() == '*')
+            if (*m_long_name.rbegin() == '*')
             {
                 // The name ends with '*'. Any specified name with the given
                 // prefix is OK.
-                if (local_option.find(local_long_name.substr(0, local_long_name.length()-1))
-                    == 0)
+                if (starts_with(option, m_long_name, long_name_folded(),
+                                m_long_name.size() - 1, long_ignore_case))
                     result = approximate_match;
             }
 
-            if (local_long_name == local_option)
+            if (equals(option, m_long_name, long_name_folded(), long_ignore_case))
             {
                 result = full_match;
             }
             else if (approx)
             {
-                if (local_long_name.find(local_option) == 0)
+                // The name starts with the given option.
+                if (option.size() <= m_long_name.size() &&
+                    (long_ignore_case
+                     ? folded_equal(option.data(), long_name_folded().data(),
+                                    option.size())
+                     : m_long_name.compare(0, option.size(), option) == 0))
                 {
                     result = approximate_match;
                 }
@@ -93,9 +308,11 @@ namespace options {
          
         if (result != full_match)
         {
-            std::string local_option(short_ignore_case ? tolower_(option) : option);
-            std::string local_short_name(short_ignore_case ? tolower_(m_short_name) : m_short_name);
-            if (local_short_name == local_option)
+            // Short names are '-' and a letter, so fold just the letter.
+            if (short_ignore_case && m_short_name.size() == 2
+                ? option.size() == 2 && option[0] == m_short_name[0] &&
+                  fold_char(option[1]) == fold_char(m_short_name[1])
+                : option == m_short_name)
             {
                 result = full_match;
             }
@@ -121,6 +338,18 @@ namespace options {
             return m_short_name;
     }
 
+    unsigned
+    OptionDescription::id(const std::string&) const
+    {
+        return m_id;
+    }
+
+    bool
+    OptionDescription::is_wildcard() const
+    {
+        return !m_long_name.empty() && *m_long_name.rbegin() == '*';
+    }
+
     std::string 
     OptionDescription::canonical_display_name(int prefix_style) const
     {
@@ -157,9 +386,31 @@ namespace options {
         } else {
             m_long_name = name;
         }
+        // Case-insensitive lookups compare against this.
+        m_long_name_folded = fold(m_long_name);
+        if (m_long_name_folded == m_long_name)
+            std::string().swap(m_long_name_folded);
+        m_id = detail::name_id(key(""));
         return *this;
     }
 
+    void
+    OptionDescription::cache_semantic()
+    {
+        const Value_semantic* s = m_value_semantic.get();
+        m_min_tokens = s ? s->min_tokens() : 0;
+        m_max_tokens = s ? s->max_tokens() : 0;
+        m_composing = s && s->is_composing();
+        m_bind_only = s && s->is_bind_only();
+        m_builtin_kind = s ? s->builtin_kind() : int(detail::custom_kind);
+    }
+
+    const std::string&
+    OptionDescription::long_name_folded() const
+    {
+        return m_long_name_folded.empty() ? m_long_name : m_long_name_folded;
+    }
+
     const std::string&
     OptionDescription::description() const
     {
@@ -204,10 +455,7 @@ namespace options {
     operator()(const char* name,
                const char* description)
     {
-        std::shared_ptr<OptionDescription> d(
-            new OptionDescription(name, new Untyped_value(true), description));
-
-        owner->add(d);
+        owner->emplace(name, 0, description);
         return *this;
     }
 
@@ -216,8 +464,7 @@ namespace options {
     operator()(const char* name,
                const Value_semantic* s)
     {
-        std::shared_ptr<OptionDescription> d(new OptionDescription(name, s));
-        owner->add(d);
+        owner->emplace(name, s, "");
         return *this;
     }
 
@@ -227,9 +474,7 @@ namespace options {
                const Value_semantic* s,
                const char* description)
     {
-        std::shared_ptr<OptionDescription> d(new OptionDescription(name, s, description));
-
-        owner->add(d);
+        owner->emplace(name, s, description);
         return *this;
     }
 
@@ -237,6 +482,8 @@ namespace options {
                                              unsigned min_description_length)
     : m_line_length(line_length)
     , m_min_description_length(min_description_length)
+    , m_name_count(0)
+    , m_generation(next_generation())
     {
         assert(m_min_description_length < m_line_length - 1);    
     }
@@ -247,6 +494,8 @@ namespace options {
     : m_caption(caption)
     , m_line_length(line_length)
     , m_min_description_length(min_description_length)
+    , m_name_count(0)
+    , m_generation(next_generation())
     {
         assert(m_min_description_length < m_line_length - 1);
     }
@@ -255,7 +504,119 @@ namespace options {
     OptionsDescription::add(std::shared_ptr<OptionDescription> desc)
     {
         m_options.push_back(desc);
+        m_long_prefix.push_back(fold_prefix(desc->m_long_name, 0));
+        m_long_prefix.push_back(fold_prefix(desc->m_long_name, 8));
+        m_short_letter.push_back(desc->m_short_name.size() == 2
+                                 ? fold_char(desc->m_short_name[1]) : '\0');
+        m_wildcard.push_back(!desc->m_long_name.empty() &&
+                             *desc->m_long_name.rbegin() == '*');
         belong_to_group.push_back(false);
+        index(static_cast<unsigned>(m_options.size() - 1));
+        if (desc->semantic()->is_required())
+            m_required_ids.set(desc->id(""));
+        if (!m_wildcard.back() && !desc->key("").empty())
+            m_key_ids.set(desc->id(""));
+        m_generation = next_generation();
+    }
+
+    const std::string&
+    OptionsDescription::indexed_name(unsigned entry) const
+    {
+        const OptionDescription& d = *m_options[(entry - 1) / 2];
+        return entry % 2 ? d.long_name_folded() : d.m_short_name;
+    }
+
+    void
+    OptionsDescription::place_name(unsigned entry)
+    {
+        const std::string& name = indexed_name(entry);
+        const std::size_t mask = m_name_table.size() - 1;
+        std::size_t h = folded_hash(name.data(), name.size()) & mask;
+        while (m_name_table[h])
+            h = (h + 1) & mask;
+        m_name_table[h] = entry;
+    }
+
+    void
+    OptionsDescription::index(unsigned i)
+    {
+        const OptionDescription& d = *m_options[i];
+        // Wildcards match by prefix of their own name: each lookup
+        // tries them all.
+        if (m_wildcard[i])
+        {
+            m_wildcards.push_back(i);
+            return;
+        }
+
+        unsigned entries[2];
+        unsigned count = 0;
+        if (!d.m_long_name.empty())
+            entries[count++] = 2 * i + 1;
+        if (!d.m_short_name.empty())
+            entries[count++] = 2 * i + 2;
+
+        // At most half full, so that probes stay short.
+        if (2 * (m_name_count + count) > m_name_table.size())
+        {
+            std::vector<unsigned> old;
+            old.swap(m_name_table);
+            m_name_table.assign(old.empty() ? 16 : 2 * old.size(), 0u);
+            for (unsigned e : old)
+                if (e)
+                    place_name(e);
+        }
+        for (unsigned k = 0; k < count; ++k)
+            place_name(entries[k]);
+        m_name_count += count;
+
+        if (d.m_long_name.empty())
+            return;
+        auto less = [this](unsigned a, unsigned b) {
+            return m_options[a]->long_name_folded() < m_options[b]->long_name_folded();
+        };
+        m_sorted.push_back(i);
+        const std::size_t n = m_sorted.size();
+        for (std::size_t k = 1; !(n & k); k <<= 1)
+        {
+            std::vector<unsigned>::iterator first = m_sorted.end() - 2 * k;
+            std::vector<unsigned>::iterator middle = m_sorted.end() - k;
+            if (k < 16)
+            {
+                // Small runs are merged by insertion, without a buffer.
+                for (std::vector<unsigned>::iterator j = middle; j != m_sorted.end(); ++j)
+                    for (std::vector<unsigned>::iterator p = j;
+                         p != first && less(*p, *(p - 1)); --p)
+                        std::iter_swap(p, p - 1);
+            }
+            else
+            {
+                std::vector<unsigned> head(first, middle);
+                std::merge(head.begin(), head.end(), middle, m_sorted.end(),
+                           first, less);
+            }
+        }
+    }
+
+    void
+    OptionsDescription::emplace(const char* name, const Value_semantic* s,
+                                const char* description)
+    {
+        std::shared_ptr<detail::Description_arena>& arena = m_arena.arena;
+        if (!arena)
+            arena = std::make_shared<detail::Description_arena>();
+
+        std::shared_ptr<const Value_semantic> semantic;
+        if (s) {
+            std::unique_ptr<const Value_semantic> owned(s);
+            arena->pool->semantics.push_back(std::move(owned));
+            semantic = std::shared_ptr<const Value_semantic>(arena->pool, s);
+        } else {
+            semantic = untyped_semantic();
+        }
+
+        add(std::shared_ptr<OptionDescription>(
+                arena, arena->emplace(name, std::move(semantic), description)));
     }
 
     OptionsDescription&
@@ -268,7 +629,44 @@ namespace options {
             add(desc.m_options[i]);
             belong_to_group.back() = true;
         }
+        if (!desc.m_constraints.empty()) {
+            m_constraints.add(desc.m_constraints);
+            m_generation = next_generation();
+        }
+
+        return *this;
+    }
+
+    OptionsDescription&
+    OptionsDescription::conflicts(const std::vector<std::string>& names)
+    {
+        m_constraints.add(detail::Constraints::conflicts, names);
+        m_generation = next_generation();
+        return *this;
+    }
+
+    OptionsDescription&
+    OptionsDescription::depends(const std::string& option,
+                                const std::vector<std::string>& needed)
+    {
+        m_constraints.add(detail::Constraints::depends, needed, option);
+        m_generation = next_generation();
+        return *this;
+    }
+
+    OptionsDescription&
+    OptionsDescription::one_of(const std::vector<std::string>& names)
+    {
+        m_constraints.add(detail::Constraints::one_of, names);
+        m_generation = next_generation();
+        return *this;
+    }
 
+    OptionsDescription&
+    OptionsDescription::at_least_one(const std::vector<std::string>& names)
+    {
+        m_constraints.add(detail::Constraints::at_least_one, names);
+        m_generation = next_generation();
         return *this;
     }
 
@@ -284,8 +682,13 @@ namespace options {
                               bool long_ignore_case,
                               bool short_ignore_case) const
     {
-        return find_nothrow(name, approx,
-                                       long_ignore_case, short_ignore_case);
+        Parse_error error;
+        const OptionDescription* d = find_nothrow(name, approx,
+                                       long_ignore_case, short_ignore_case,
+                                       &error);
+        if (error)
+            throw Options_error(error);
+        return d;
     }
 
     const std::vector< std::shared_ptr<OptionDescription> >& 
@@ -294,45 +697,165 @@ namespace options {
         return m_options;
     }
 
+    std::shared_ptr<const detail::Defaults>
+    OptionsDescription::defaults() const
+    {
+        std::shared_ptr<const detail::Defaults> current = std::atomic_load(&m_defaults);
+        if (current && current->generation == m_generation)
+            return current;
+
+        // Threads that get here together each make one; any will do.
+        std::shared_ptr<detail::Defaults> made = std::make_shared<detail::Defaults>();
+        made->generation = m_generation;
+        for (const auto& d : m_options)
+        {
+            const std::string& key = d->key("");
+            if (key.empty())
+                continue;
+            const Value_semantic& semantic = d->value_semantic();
+            std::function<Any()> compute = semantic.default_callback();
+            Any value;
+            if (!compute && !semantic.apply_default(value))
+                continue;
+
+            detail::Defaults::entry e;
+            e.key = key;
+            e.id = d->id("");
+            e.semantic = d->semantic();
+            if (!d->is_bind_only())
+                e.value = compute
+                    ? std::make_shared<detail::Default_value>(std::move(compute))
+                    : std::make_shared<detail::Default_value>(std::move(value));
+            made->entries.push_back(std::move(e));
+        }
+        std::atomic_store(&m_defaults, std::shared_ptr<const detail::Defaults>(made));
+        return made;
+    }
+
     const OptionDescription*
     OptionsDescription::find_nothrow(const std::string& name, 
                                       bool approx,
                                       bool long_ignore_case,
-                                      bool short_ignore_case) const
+                                      bool short_ignore_case,
+                                      Parse_error* error) const
     {
-        std::shared_ptr<OptionDescription> found;
-        bool had_full_match = false;
-        vector<string> approximate_matches;
-        vector<string> full_matches;
-        
-        for(unsigned i = 0; i < m_options.size(); ++i)
-        {
+        const OptionDescription* found = 0;
+        unsigned full_matches = 0;
+        unsigned approximate_matches = 0;
+
+        // For naming the candidates of an ambiguous name: an option can
+        // only match if its long name starts with 'name' (folded, up to
+        // sixteen bytes), its short name is 'name', or its long name
+        // ends with '*'. Folding keeps this a superset of the
+        // case-sensitive matches too.
+        uint64_t mask0, mask1;
+        const uint64_t prefix0 = fold_prefix(name, 0, &mask0);
+        const uint64_t prefix1 = fold_prefix(name, 8, &mask1);
+        const char letter = name.size() == 2 ? fold_char(name[1]) : '\0';
+        auto may_match = [&](unsigned i) {
+            return (((m_long_prefix[2*i] ^ prefix0) & mask0) == 0 &&
+                    ((m_long_prefix[2*i+1] ^ prefix1) & mask1) == 0) ||
+                (letter && m_short_letter[i] == letter) ||
+                m_wildcard[i];
+        };
+
+        auto consider = [&](unsigned i) {
             OptionDescription::match_result r = 
                 m_options[i]->match(name, approx, long_ignore_case, short_ignore_case);
 
             if (r == OptionDescription::no_match)
-                continue;
+                return;
 
             if (r == OptionDescription::full_match)
             {                
-                full_matches.push_back(m_options[i]->key(name));
-                found = m_options[i];
-                had_full_match = true;
+                ++full_matches;
+                found = m_options[i].get();
             } 
             else 
             {                        
-                approximate_matches.push_back(m_options[i]->key(name));
-                if (!had_full_match)
-                    found = m_options[i];
+                ++approximate_matches;
+                if (!full_matches)
+                    found = m_options[i].get();
             }
+        };
+
+        // The index gives, folded, a superset of the options match()
+        // accepts, each once; the order they come in does not change
+        // the outcome. An empty name is matched the slow way.
+        const char* q = name.data();
+        const std::size_t n = name.size();
+        if (!n)
+        {
+            for (unsigned i = 0; i < m_options.size(); ++i)
+                consider(i);
+        }
+        else
+        {
+            for (unsigned i : m_wildcards)
+                consider(i);
+
+            // Long names starting with 'name', from each sorted run.
+            if (approx && !m_sorted.empty())
+            {
+                std::size_t k = 1;
+                while (2 * k <= m_sorted.size())
+                    k *= 2;
+                std::vector<unsigned>::const_iterator first = m_sorted.begin();
+                for (; k; k >>= 1)
+                {
+                    if (!(m_sorted.size() & k))
+                        continue;
+                    std::vector<unsigned>::const_iterator last = first + k;
+                    std::vector<unsigned>::const_iterator j = std::lower_bound(
+                        first, last, name, [&](unsigned i, const std::string&) {
+                            return compare_folded(m_options[i]->long_name_folded(),
+                                                  q, n) < 0;
+                        });
+                    for (; j != last &&
+                           starts_folded(m_options[*j]->long_name_folded(), q, n); ++j)
+                        consider(*j);
+                    first = last;
+                }
+            }
+
+            // Long names equal to 'name', unless seen above, and short
+            // names, unless their option was.
+            if (!m_name_table.empty())
+            {
+                const std::size_t mask = m_name_table.size() - 1;
+                for (std::size_t h = folded_hash(q, n) & mask; m_name_table[h];
+                     h = (h + 1) & mask)
+                {
+                    const unsigned e = m_name_table[h];
+                    if (!same_folded(indexed_name(e), q, n))
+                        continue;
+                    const unsigned i = (e - 1) / 2;
+                    const std::string& folded = m_options[i]->long_name_folded();
+                    if (e % 2 ? !approx
+                              : !(approx ? starts_folded(folded, q, n)
+                                         : same_folded(folded, q, n)))
+                        consider(i);
+                }
+            }
+        }
+        if (full_matches > 1 || (!full_matches && approximate_matches > 1))
+        {
+            if (error)
+            {
+                // Only now is it worth naming the candidates.
+                OptionDescription::match_result wanted = full_matches
+                    ? OptionDescription::full_match
+                    : OptionDescription::approximate_match;
+                *error = Parse_error(Parse_error::ambiguous_option, -1, name);
+                for(unsigned i = 0; i < m_options.size(); ++i)
+                    if (may_match(i) && m_options[i]->match(name, approx, long_ignore_case,
+                                            short_ignore_case) == wanted)
+                        error->candidates.push_back(m_options[i]->key(name));
+            }
+            return 0;
         }
-        if (full_matches.size() > 1) 
-            throw std::exception();
-        
-        if (full_matches.empty() && approximate_matches.size() > 1)
-            throw std::exception();
 
-        return found.get();
+        return found;
     }
 
     
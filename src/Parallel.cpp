@@ -0,0 +1,65 @@
+#include "program_options/detail/Parallel.hpp"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace options { namespace detail {
+
+    void
+    parallel_for(std::size_t n, unsigned threads,
+                 const std::function<void(std::size_t)>& f)
+    {
+        if (threads > n)
+            threads = static_cast<unsigned>(n);
+        if (threads <= 1)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                f(i);
+            return;
+        }
+
+        std::atomic<std::size_t> next(0);
+        std::mutex mutex;
+        std::exception_ptr failure;
+
+        auto work = [&]() {
+            for (;;)
+            {
+                std::size_t i = next++;
+                if (i >= n)
+                    return;
+                try {
+                    f(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!failure)
+                        failure = std::current_exception();
+                    next = n;
+                    return;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(work);
+        work();
+        for (auto& t : pool)
+            t.join();
+
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+    unsigned
+    hardware_threads()
+    {
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+}}
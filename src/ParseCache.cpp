@@ -0,0 +1,130 @@
+#include "program_options/ParseCache.hpp"
+#include "program_options/Parsers.hpp"
+
+#include <cstring>
+
+namespace options {
+
+    namespace {
+
+        /* Mixes eight bytes at a time; collisions only cost a compare,
+           since entries keep their tokens. */
+        uint64_t hash_bytes(const char* p, std::size_t n, uint64_t seed)
+        {
+            const uint64_t k = 0x9E3779B97F4A7C15ULL;
+            uint64_t h = seed ^ (n * k);
+            for (; n >= 8; p += 8, n -= 8)
+            {
+                uint64_t w;
+                std::memcpy(&w, p, 8);
+                h = (h ^ w) * k;
+                h ^= h >> 29;
+            }
+            uint64_t w = 0;
+            std::memcpy(&w, p, n);
+            h = (h ^ w) * k;
+            return h ^ (h >> 32);
+        }
+    }
+
+    ParseCache::ParseCache(std::size_t capacity)
+    : m_capacity(capacity), m_hits(0), m_misses(0)
+    {
+    }
+
+    ParseCache::lru_list::iterator
+    ParseCache::find(uint64_t hash, unsigned long generation,
+                     const std::string& tokens)
+    {
+        auto range = m_index.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i)
+            if (i->second->generation == generation && i->second->tokens == tokens)
+                return i->second;
+        return m_entries.end();
+    }
+
+    std::shared_ptr<const VariablesMap>
+    ParseCache::parse(int argc, const char* const argv[],
+                      const OptionsDescription& desc)
+    {
+        std::string tokens;
+        for (int i = 1; i < argc; ++i)
+            tokens.append(argv[i]).push_back('\0');
+        const unsigned long generation = desc.generation();
+        const uint64_t hash = hash_bytes(tokens.data(), tokens.size(), generation);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            lru_list::iterator i = find(hash, generation, tokens);
+            if (i != m_entries.end())
+            {
+                ++m_hits;
+                m_entries.splice(m_entries.begin(), m_entries, i);
+                return i->map;
+            }
+            ++m_misses;
+        }
+
+        // Parsed without the lock; a thread that raced us to the same
+        // line just finds its entry already there.
+        std::shared_ptr<VariablesMap> map = std::make_shared<VariablesMap>();
+        store(command_line_parser(argc, argv).options(desc).run(), *map);
+        check_constraints(*map, desc);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_capacity == 0 || find(hash, generation, tokens) != m_entries.end())
+            return map;
+
+        entry e;
+        e.hash = hash;
+        e.generation = generation;
+        e.tokens.swap(tokens);
+        e.map = map;
+        m_entries.push_front(std::move(e));
+        m_index.emplace(hash, m_entries.begin());
+
+        if (m_entries.size() > m_capacity)
+        {
+            lru_list::iterator last = std::prev(m_entries.end());
+            auto range = m_index.equal_range(last->hash);
+            for (auto i = range.first; i != range.second; ++i)
+                if (i->second == last)
+                {
+                    m_index.erase(i);
+                    break;
+                }
+            m_entries.pop_back();
+        }
+        return map;
+    }
+
+    unsigned long
+    ParseCache::hits() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    unsigned long
+    ParseCache::misses() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+
+    std::size_t
+    ParseCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    void
+    ParseCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_index.clear();
+    }
+
+}
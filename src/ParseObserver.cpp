@@ -0,0 +1,16 @@
+#include "program_options/ParseObserver.hpp"
+
+namespace options {
+
+    namespace detail {
+        std::atomic<ParseObserver*> parse_observer(nullptr);
+    }
+
+    ParseObserver*
+    set_parse_observer(ParseObserver* observer)
+    {
+        return detail::parse_observer.exchange(observer,
+                                               std::memory_order_acq_rel);
+    }
+
+}
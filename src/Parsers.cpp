@@ -4,14 +4,154 @@
 #include "program_options/VariablesMap.hpp"
 #include "program_options/PositionalOptions.hpp"
 
+#include <cctype>
+#include <cstring>
+
+#ifdef _WIN32
+#include <stdlib.h>
+#define environ _environ
+#else
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
 namespace options {
 
+    void
+    ParsedOptions::values(std::size_t i, std::vector<std::string>& out) const
+    {
+        const entry& e = entries[i];
+        out.resize(e.values);
+        for (unsigned k = 0; k < e.values; ++k)
+            out[k].assign(tokens.token(e.first + 1 + k),
+                          tokens.length(e.first + 1 + k));
+    }
+
+    Basic_option
+    ParsedOptions::option(std::size_t i) const
+    {
+        const entry& e = entries[i];
+        Basic_option opt;
+        opt.string_key = tokens.str(e.first);
+        values(i, opt.value);
+        opt.original_tokens.reserve(e.originals);
+        for (unsigned k = 0; k < e.originals; ++k)
+            opt.original_tokens.push_back(tokens.str(e.first + 1 + e.values + k));
+        opt.position_key = e.position_key;
+        opt.token_index = e.token_index;
+        opt.unregistered = e.unregistered;
+        opt.case_insensitive = e.case_insensitive;
+        opt.hasValue = e.has_value;
+        return opt;
+    }
+
+    std::vector<Basic_option>
+    ParsedOptions::options() const
+    {
+        std::vector<Basic_option> result;
+        result.reserve(entries.size());
+        for (std::size_t i = 0; i < entries.size(); ++i)
+            result.push_back(option(i));
+        return result;
+    }
+
+    void
+    ParsedOptions::push_back(const Basic_option& opt)
+    {
+        entry e;
+        e.first = static_cast<unsigned>(tokens.size());
+        tokens.push_back(opt.string_key);
+        for (const auto& v : opt.value)
+            tokens.push_back(v);
+        for (const auto& t : opt.original_tokens)
+            tokens.push_back(t);
+        e.values = static_cast<unsigned>(opt.value.size());
+        e.originals = static_cast<unsigned>(opt.original_tokens.size());
+        e.position_key = opt.position_key;
+        e.token_index = opt.token_index;
+        e.unregistered = opt.unregistered;
+        e.case_insensitive = opt.case_insensitive;
+        e.has_value = opt.hasValue;
+        entries.push_back(e);
+    }
+
 	VariablesMap  parse_args(int argc, const char* const argv[],
                        const OptionsDescription& desc)
     {
     	VariablesMap vm;
     	store(Basic_command_line_parser(argc, argv).options(desc).run(), vm);
+    	check_constraints(vm, desc);
         return vm;
     }
 
+	VariablesMap  parse_args(int argc, const wchar_t* const argv[],
+                       const OptionsDescription& desc)
+    {
+    	VariablesMap vm;
+    	store(Basic_command_line_parser(argc, argv).options(desc).run(), vm);
+    	check_constraints(vm, desc);
+        return vm;
+    }
+
+	Expected<VariablesMap>  try_parse_args(int argc, const char* const argv[],
+                       const OptionsDescription& desc)
+    {
+    	Expected<ParsedOptions> parsed =
+    		Basic_command_line_parser(argc, argv).options(desc).try_run();
+    	if (!parsed)
+    		return Expected<VariablesMap>(parsed.error());
+
+    	VariablesMap vm;
+    	Expected<void> stored = try_store(*parsed, vm);
+    	if (stored)
+    		stored = try_check_constraints(vm, desc);
+    	if (!stored)
+    		return Expected<VariablesMap>(stored.error());
+        return Expected<VariablesMap>(std::move(vm));
+    }
+
+    ParsedOptions
+    parse_environment(const OptionsDescription& desc,
+                      const std::function<std::string(const std::string&)>& name_mapper)
+    {
+        ParsedOptions result(&desc);
+        std::string name;
+        for (char** var = environ; var && *var; ++var)
+        {
+            const char* eq = std::strchr(*var, '=');
+            if (!eq)
+                continue;
+            name = name_mapper(std::string(*var, eq - *var));
+            if (name.empty() || !desc.find_nothrow(name, false))
+                continue;
+
+            ParsedOptions::entry e;
+            e.first = static_cast<unsigned>(result.tokens.size());
+            e.values = 1;
+            e.has_value = true;
+            result.tokens.push_back(name);
+            result.tokens.push_back(eq + 1, std::strlen(eq + 1));
+            result.entries.push_back(e);
+        }
+        return result;
+    }
+
+    ParsedOptions
+    parse_environment(const OptionsDescription& desc, const std::string& prefix)
+    {
+        return parse_environment(desc, [&prefix](const std::string& var) {
+            std::string name;
+            if (var.size() > prefix.size() &&
+                var.compare(0, prefix.size(), prefix) == 0)
+            {
+                name.reserve(var.size() - prefix.size());
+                for (std::size_t i = prefix.size(); i < var.size(); ++i)
+                    name += static_cast<char>(
+                        std::tolower(static_cast<unsigned char>(var[i])));
+            }
+            return name;
+        });
+    }
+
 }
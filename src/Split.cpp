@@ -0,0 +1,170 @@
+#include "program_options/Parsers.hpp"
+#include "program_options/detail/Bits.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace options {
+
+    namespace {
+
+        enum byte_class { plain = 0, separator, quote, escape };
+
+        /* The byte classes of one split_unix call, plus the distinct
+           special bytes for the vector scan. Escape wins over quote
+           and quote over separator when a byte is in several sets. */
+        struct classes
+        {
+            classes(const std::string& seperator, const std::string& quotes,
+                    const std::string& escapes)
+            : count(0)
+            {
+                std::memset(table, plain, sizeof(table));
+                add(seperator, separator);
+                add(quotes, quote);
+                add(escapes, escape);
+            }
+
+            void add(const std::string& set, byte_class c)
+            {
+                for (std::string::size_type i = 0; i < set.size(); ++i)
+                {
+                    unsigned char b = set[i];
+                    if (table[b] == plain && count < sizeof(special))
+                        special[count] = b;
+                    if (table[b] == plain)
+                        ++count;
+                    table[b] = static_cast<unsigned char>(c);
+                }
+            }
+
+            /* Bit i is set when p[i] is special, for i < n <= 16. */
+            unsigned scan(const char* p, std::size_t n) const
+            {
+#if defined(__SSE2__)
+                if (n == 16 && count <= sizeof(special))
+                {
+                    __m128i v = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(p));
+                    __m128i hit = _mm_setzero_si128();
+                    for (unsigned i = 0; i < count; ++i)
+                        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(
+                            v, _mm_set1_epi8(static_cast<char>(special[i]))));
+                    return static_cast<unsigned>(_mm_movemask_epi8(hit));
+                }
+#endif
+                unsigned mask = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                    if (table[static_cast<unsigned char>(p[i])] != plain)
+                        mask |= 1u << i;
+                return mask;
+            }
+
+            unsigned char table[256];
+            unsigned char special[16];
+            unsigned count;
+        };
+    }
+
+    void
+    split_unix(const std::string& cmdline, TokenBuffer& result,
+               const std::string& seperator, const std::string& quotes,
+               const std::string& escapes)
+    {
+        const classes cls(seperator, quotes, escapes);
+        const char* p = cmdline.data();
+        const std::size_t n = cmdline.size();
+
+        // Tokens never outgrow the input: each one ends at a byte that
+        // was dropped, or at the end of the line.
+        result.reserve(n + 1, n / 2 + 1);
+
+        bool in_token = false;
+        bool escaped = false;
+        char open_quote = 0;
+
+        for (std::size_t block = 0; block < n; block += 16)
+        {
+            const std::size_t len = n - block < 16 ? n - block : 16;
+            unsigned mask = cls.scan(p + block, len);
+            std::size_t run = block;
+            while (mask)
+            {
+                const std::size_t i = block + detail::count_trailing_zeros(mask);
+                mask &= mask - 1;
+
+                if (run != i)
+                {
+                    result.append(p + run, p + i);
+                    in_token = true;
+                    escaped = false;
+                }
+                run = i + 1;
+
+                const char c = p[i];
+                if (escaped)
+                {
+                    result.append(c);
+                    escaped = false;
+                    continue;
+                }
+                switch (cls.table[static_cast<unsigned char>(c)])
+                {
+                case escape:
+                    escaped = true;
+                    in_token = true;
+                    break;
+                case quote:
+                    in_token = true;
+                    if (!open_quote)
+                        open_quote = c;
+                    else if (c == open_quote)
+                        open_quote = 0;
+                    else
+                        result.append(c);
+                    break;
+                default:
+                    if (open_quote)
+                        result.append(c);
+                    else if (in_token)
+                    {
+                        result.finish();
+                        in_token = false;
+                    }
+                    break;
+                }
+            }
+            if (run != block + len)
+            {
+                result.append(p + run, p + block + len);
+                in_token = true;
+                escaped = false;
+            }
+        }
+
+        // A trailing escape stands for itself.
+        if (escaped)
+            result.append(p[n-1]);
+        if (in_token)
+            result.finish();
+    }
+
+    std::vector<std::string>
+    split_unix(const std::string& cmdline, const std::string& seperator,
+               const std::string& quote, const std::string& escape)
+    {
+        TokenBuffer tokens;
+        split_unix(cmdline, tokens, seperator, quote, escape);
+
+        std::vector<std::string> result;
+        result.reserve(tokens.size());
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+            result.push_back(tokens.str(i));
+        return result;
+    }
+
+}
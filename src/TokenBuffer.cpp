@@ -0,0 +1,57 @@
+#include "program_options/TokenBuffer.hpp"
+
+#include <cstring>
+
+namespace options {
+
+    TokenBuffer::TokenBuffer(int argc, const char* const argv[])
+        : m_offsets(1, 0)
+    {
+        std::size_t bytes = 0;
+        for (int i = 0; i < argc; ++i)
+            bytes += std::strlen(argv[i]) + 1;
+        reserve(bytes, argc > 0 ? argc : 0);
+        for (int i = 0; i < argc; ++i)
+            push_back(argv[i], std::strlen(argv[i]));
+    }
+
+    TokenBuffer::TokenBuffer(const std::vector<std::string>& tokens)
+        : m_offsets(1, 0)
+    {
+        std::size_t bytes = 0;
+        for (const auto& t : tokens)
+            bytes += t.size() + 1;
+        reserve(bytes, tokens.size());
+        for (const auto& t : tokens)
+            push_back(t);
+    }
+
+    void
+    TokenBuffer::push_back(const char* s, std::size_t n)
+    {
+        m_data.append(s, n);
+        finish();
+    }
+
+    void
+    TokenBuffer::finish()
+    {
+        m_data.push_back('\0');
+        m_offsets.push_back(m_data.size());
+    }
+
+    void
+    TokenBuffer::clear()
+    {
+        m_data.clear();
+        m_offsets.resize(1);
+    }
+
+    void
+    TokenBuffer::reserve(std::size_t bytes, std::size_t tokens)
+    {
+        m_data.reserve(m_data.size() + bytes);
+        m_offsets.reserve(m_offsets.size() + tokens);
+    }
+
+}
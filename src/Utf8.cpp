@@ -0,0 +1,220 @@
+#include "program_options/detail/Utf8.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPTIONS_UTF8_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace options { namespace detail {
+
+    namespace {
+
+        const wchar_t replacement = 0xFFFD;
+
+        /* Length of the ASCII prefix of [p, p + size). */
+        std::size_t ascii_prefix(const char* p, std::size_t size)
+        {
+            std::size_t i = 0;
+#ifdef OPTIONS_UTF8_SSE2
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                int high = _mm_movemask_epi8(x);
+                if (high)
+                {
+                    unsigned bits = static_cast<unsigned>(high);
+                    while (!(bits & 1)) { bits >>= 1; ++i; }
+                    return i;
+                }
+            }
+#else
+            for (; i + 8 <= size; i += 8)
+            {
+                uint64_t w;
+                std::memcpy(&w, p + i, 8);
+                if (w & 0x8080808080808080ULL)
+                    break;
+            }
+#endif
+            while (i < size && !(static_cast<unsigned char>(p[i]) & 0x80))
+                ++i;
+            return i;
+        }
+
+        void widen(const char* p, std::size_t size, std::wstring& out)
+        {
+            std::size_t base = out.size();
+            out.resize(base + size);
+            wchar_t* o = &out[0] + base;
+            for (std::size_t i = 0; i < size; ++i)
+                o[i] = static_cast<wchar_t>(static_cast<unsigned char>(p[i]));
+        }
+
+        void append_code_point(unsigned long cp, std::wstring& out)
+        {
+            if (sizeof(wchar_t) == 2 && cp > 0xFFFF)
+            {
+                cp -= 0x10000;
+                out += static_cast<wchar_t>(0xD800 + (cp >> 10));
+                out += static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+            }
+            else
+                out += static_cast<wchar_t>(cp);
+        }
+
+        bool continuation(unsigned char c)
+        {
+            return (c & 0xC0) == 0x80;
+        }
+
+        /* Decodes one multi-byte sequence at p[0]; returns the number of
+           bytes consumed, with 'cp' set to U+FFFD for a malformed one. */
+        std::size_t decode(const unsigned char* p, std::size_t size,
+                           unsigned long& cp)
+        {
+            unsigned char c = p[0];
+            cp = replacement;
+            if (c >= 0xC2 && c <= 0xDF)
+            {
+                if (size < 2 || !continuation(p[1]))
+                    return 1;
+                cp = ((c & 0x1FUL) << 6) | (p[1] & 0x3F);
+                return 2;
+            }
+            if (c >= 0xE0 && c <= 0xEF)
+            {
+                unsigned char lo = c == 0xE0 ? 0xA0 : 0x80;
+                unsigned char hi = c == 0xED ? 0x9F : 0xBF;
+                if (size < 3 || p[1] < lo || p[1] > hi || !continuation(p[2]))
+                    return 1;
+                cp = ((c & 0x0FUL) << 12) | ((p[1] & 0x3FUL) << 6) | (p[2] & 0x3F);
+                return 3;
+            }
+            if (c >= 0xF0 && c <= 0xF4)
+            {
+                unsigned char lo = c == 0xF0 ? 0x90 : 0x80;
+                unsigned char hi = c == 0xF4 ? 0x8F : 0xBF;
+                if (size < 4 || p[1] < lo || p[1] > hi ||
+                    !continuation(p[2]) || !continuation(p[3]))
+                    return 1;
+                cp = ((c & 0x07UL) << 18) | ((p[1] & 0x3FUL) << 12) |
+                     ((p[2] & 0x3FUL) << 6) | (p[3] & 0x3F);
+                return 4;
+            }
+            return 1;
+        }
+
+        void append_utf8(unsigned long cp, std::string& out)
+        {
+            if (cp >= 0xD800 && cp <= 0xDFFF)
+                cp = replacement;
+            if (cp > 0x10FFFF)
+                cp = replacement;
+            if (cp < 0x80)
+                out += static_cast<char>(cp);
+            else if (cp < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+    }
+
+    bool is_ascii(const char* p, std::size_t size)
+    {
+        return ascii_prefix(p, size) == size;
+    }
+
+    void from_utf8(const char* p, std::size_t size, std::wstring& out)
+    {
+        std::size_t i = ascii_prefix(p, size);
+        if (i == size)
+        {
+            widen(p, size, out);
+            return;
+        }
+
+        // Never more code units than bytes.
+        out.reserve(out.size() + size);
+        widen(p, i, out);
+        const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+        while (i < size)
+        {
+            std::size_t run = ascii_prefix(p + i, size - i);
+            widen(p + i, run, out);
+            i += run;
+            if (i == size)
+                break;
+            unsigned long cp;
+            i += decode(u + i, size - i, cp);
+            append_code_point(cp, out);
+        }
+    }
+
+    std::wstring from_utf8(const std::string& s)
+    {
+        std::wstring result;
+        from_utf8(s.data(), s.size(), result);
+        return result;
+    }
+
+    void to_utf8(const wchar_t* p, std::size_t size, std::string& out)
+    {
+        std::size_t i = 0;
+        while (i < size && static_cast<unsigned long>(p[i]) < 0x80)
+            ++i;
+        out.reserve(out.size() + (i == size ? size : size + size / 2));
+        for (std::size_t k = 0; k < i; ++k)
+            out += static_cast<char>(p[k]);
+
+        for (; i < size; ++i)
+        {
+            unsigned long cp = static_cast<unsigned long>(p[i]);
+            if (sizeof(wchar_t) == 2)
+            {
+                cp &= 0xFFFF;
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < size)
+                {
+                    unsigned long lo = static_cast<unsigned long>(p[i + 1]) & 0xFFFF;
+                    if (lo >= 0xDC00 && lo <= 0xDFFF)
+                    {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        ++i;
+                    }
+                }
+            }
+            append_utf8(cp, out);
+        }
+    }
+
+    std::string to_utf8(const std::wstring& s)
+    {
+        std::string result;
+        to_utf8(s.data(), s.size(), result);
+        return result;
+    }
+
+    void to_text(std::ostream& os, const std::wstring& s)
+    {
+        os << to_utf8(s);
+    }
+
+}}
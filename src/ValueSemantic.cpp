@@ -2,6 +2,7 @@
 #include "program_options/ValueSemantic.hpp"
 #include <program_options/detail/Cmdline.hpp>
 #include "program_options/Any.hpp"
+#include "program_options/detail/Utf8.hpp"
 #include <set>
 
 #include <cctype>
@@ -18,6 +19,40 @@ namespace options {
        xparse(value_store, new_tokens);
     }
 
+    bool
+    Value_semantic_codecvt_helper<char>::
+    parse_checked(Any& value_store,
+                  const std::vector<std::string>& new_tokens) const
+    {
+       return xparse_checked(value_store, new_tokens);
+    }
+
+    std::vector<std::wstring>
+    detail::tokens_as(const std::vector<std::string>& new_tokens, wchar_t)
+    {
+        std::vector<std::wstring> tokens(new_tokens.size());
+        for (size_t i = 0; i < new_tokens.size(); ++i)
+            detail::from_utf8(new_tokens[i].data(), new_tokens[i].size(),
+                              tokens[i]);
+        return tokens;
+    }
+
+    void 
+    Value_semantic_codecvt_helper<wchar_t>::
+    parse(Any& value_store, 
+          const std::vector<std::string>& new_tokens) const
+    {
+        xparse(value_store, detail::tokens_as(new_tokens, wchar_t()));
+    }
+
+    bool
+    Value_semantic_codecvt_helper<wchar_t>::
+    parse_checked(Any& value_store,
+                  const std::vector<std::string>& new_tokens) const
+    {
+        return xparse_checked(value_store, detail::tokens_as(new_tokens, wchar_t()));
+    }
+
      std::string arg("arg");
 
     std::string
@@ -79,5 +114,10 @@ namespace options {
     {
         v = (get_single_string(xs));
     }
+
+    void validate(Any& v, const vector<wstring>& xs, std::wstring*, int)
+    {
+        v = (get_single_string(xs));
+    }
        
 }
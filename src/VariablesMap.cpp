@@ -2,15 +2,140 @@
 #include "program_options/OptionsDescription.hpp"
 #include "program_options/ValueSemantic.hpp"
 #include "program_options/VariablesMap.hpp"
+#include "program_options/ParseObserver.hpp"
+#include "program_options/detail/BuiltinValue.hpp"
+#include "program_options/detail/Parallel.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <exception>
+#include <unordered_map>
 #include <iostream>
 
 namespace  options {
 
     using namespace std;
 
-    void store(const ParsedOptions& options, VariablesMap& map)
+    static std::string joined(const std::vector<std::string>& tokens)
+    {
+        std::string result;
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+            result += (i ? " " : "") + tokens[i];
+        return result;
+    }
+
+    /* Converts the values of one occurrence of 'd' into 'v', or into
+       the variable 'd' is bound to when 'v' is null, 'first' telling
+       whether it holds its default. Unless 'checked', only a bound
+       variable can report an invalid value. */
+    static bool convert(const OptionDescription& d, VariableValue* v,
+                        const vector<string>& values, bool first, bool checked)
+    {
+        const Value_semantic& semantic = d.value_semantic();
+        if (!v)
+            return semantic.parse_bound(values, first);
+        if (d.builtin_kind() && !values.empty())
+            return detail::parse_builtin(d.builtin_kind(), v->value(),
+                                         values, checked);
+        if (checked)
+            return semantic.parse_checked(v->value(), values);
+        semantic.parse(v->value(), values);
+        return true;
+    }
+
+    /* Applies the default values of 'desc' to the options 'map' has no
+       value for, as coming from 'source', and records its required
+       options. */
+    static void store_defaults(const OptionsDescription& desc, VariablesMap& map,
+                               unsigned source)
+    {
+        std::map<std::string, VariableValue>& m = map;
+        ParseObserver* observer = detail::observer();
+
+        // The values are shared, not copied; see VariableValue::m_default.
+        std::shared_ptr<const detail::Defaults> defaults = desc.defaults();
+        for (const auto& e : defaults->entries)
+        {
+            if (map.m_present.test(e.id))
+                continue;
+            if (!e.value) {
+                if (!e.semantic->apply_default_bound())
+                    continue;
+            }
+            else {
+                // An entry without a value, as CommandServer leaves
+                // between lines, is reused.
+                std::map<std::string, VariableValue>::iterator i = m.lower_bound(e.key);
+                if (i != m.end() && i->first == e.key && !i->second.empty())
+                    continue;
+                VariableValue& v = i != m.end() && i->first == e.key ? i->second
+                    : m.emplace_hint(i, e.key, VariableValue())->second;
+                v.defaulted = true;
+                v.m_default = e.value;
+                v.m_value_semantic = e.semantic;
+                v.m_source = static_cast<unsigned short>(source);
+            }
+            map.m_present.set(e.id);
+            map.m_defaulted.set(e.id);
+            if (observer)
+                observer->default_applied(e.key, detail::now());
+        }
+
+        map.m_required |= desc.required_ids();
+    }
+
+    /* The id sets store() keeps an option in, and its id there. The
+       keys of wildcard options come from the input, so they are not
+       interned but numbered by the map, in sets of its own. */
+    struct option_sets
+    {
+        option_sets(VariablesMap& map, const OptionDescription& d,
+                    const string& key)
+        : final(&map.m_final), present(&map.m_present),
+          defaulted(&map.m_defaulted), id(d.id(key)),
+          wildcard(d.is_wildcard())
+        {
+            if (wildcard)
+            {
+                final = &map.m_wildcard_final;
+                present = &map.m_wildcard_present;
+                defaulted = &map.m_wildcard_defaulted;
+                id = map.m_wildcard_ids.emplace(key, map.m_wildcard_ids.size())
+                     .first->second;
+            }
+        }
+
+        // Whether the option has no value yet other than a default.
+        bool fresh() const { return !present->test(id) || defaulted->test(id); }
+
+        void given()
+        {
+            present->set(id);
+            defaulted->reset(id);
+        }
+
+        detail::Id_set* final;
+        detail::Id_set* present;
+        detail::Id_set* defaulted;
+        unsigned id;
+        bool wildcard;
+    };
+
+    /* Where option 'i' of 'options' is, for VariableValue::position(). */
+    static int position_of(const ParsedOptions& options, std::size_t i)
+    {
+        int token = options.entries[i].token_index;
+        return token >= 0 ? token : static_cast<int>(i);
+    }
+
+    /* Without 'error' an ambiguous name throws and an invalid value is
+       skipped, as store() always did. With it, both stop the store and
+       are reported there; what was stored until then stays. Values are
+       recorded as coming from 'source'; the defaults are left out
+       unless 'defaults'. */
+    static bool store_options(const ParsedOptions& options, VariablesMap& map,
+                              Parse_error* error, unsigned source = 0,
+                              bool defaults = true)
     {       
         assert(options.description);
 
@@ -18,90 +143,618 @@ namespace  options {
 
         std::map<std::string, VariableValue>& m = map;
 
-        std::set<std::string> new_final;
+        detail::Id_set new_final, new_wildcard_final;
+
+        ParseObserver* observer = detail::observer();
 
         string option_name;
-        string original_token;
+        // Reused across options, so their strings keep their capacity.
+        vector<string> values;
+        Parse_error ambiguity;
+        bool failed = false;
 
-        for (auto var : options.options)
+        for (std::size_t i = 0; i < options.size(); ++i)
         {
-            option_name = var.string_key;
-            original_token = var.original_tokens.size() ?
-                var.original_tokens[0] :
-                option_name;
-
-            if (option_name.empty())
+            const ParsedOptions::entry& var = options.entries[i];
+            if (!options.key_length(i))
                 continue;
 
             if (var.unregistered)
                 continue;
 
-            if (map.m_final.count(option_name))
-                continue;
+            option_name.assign(options.key(i), options.key_length(i));
 
-            string original_token = var.original_tokens.size() ?
-                var.original_tokens[0]     : "";
+            const OptionDescription* d = desc.find_nothrow(option_name,
+                                                    var.has_value, false, false,
+                                                    &ambiguity);
 
-            const OptionDescription* d = desc.find(option_name, var.hasValue,
-                                                    false, false);
+            if (ambiguity)
+            {
+                ambiguity.token_index = var.token_index;
+                if (!error)
+                    throw Options_error(ambiguity);
+                *error = std::move(ambiguity);
+                failed = true;
+                break;
+            }
 
             if(!d) continue;
-            VariableValue& v = m[option_name];            
-            if (v.isDefaulted()) {
-                v = VariableValue();
+
+            // An abbreviation is stored under the name it stands for.
+            option_name = d->key(option_name);
+            option_sets sets(map, *d, option_name);
+
+            if (sets.final->test(sets.id))
+                continue;
+
+            // Bound options skip the map and go to their variable.
+            const Value_semantic& semantic = d->value_semantic();
+            const bool bound = d->is_bind_only();
+            VariableValue* v = bound ? 0 : &m[option_name];
+            // Only composing options accumulate over repeated occurrences;
+            // for the others the latest occurrence replaces the value.
+            if (v && (v->isDefaulted() || !d->is_composing())) {
+                *v = VariableValue();
             }
                 
-            d->semantic()->parse(v.value(), var.value);
+            options.values(i, values);
+            ParseObserver::time_point start;
+            if (observer)
+                start = detail::now();
+            bool valid = convert(*d, v, values, sets.fresh(), error != 0);
+            if (observer)
+                observer->value_converted(option_name, semantic,
+                                          start, detail::now());
+
+            if (!valid && error)
+            {
+                *error = Parse_error(Parse_error::invalid_value,
+                                     var.token_index, joined(values));
+                error->option = option_name;
+                if (v && v->empty())
+                    m.erase(option_name);
+                failed = true;
+                break;
+            }
 
-            v.m_value_semantic = d->semantic();
+            if (v && v->m_value_semantic.get() != &semantic)
+                v->m_value_semantic = d->semantic();
+            if (v)
+            {
+                v->m_source = static_cast<unsigned short>(source);
+                v->m_position = position_of(options, i);
+            }
                 
-            if (!d->semantic()->is_composing())
-                new_final.insert(option_name);
+            if (bound ? valid : !v->empty())
+                sets.given();
+            if (!d->is_composing())
+                (sets.wildcard ? new_wildcard_final : new_final).set(sets.id);
         }
 
-        map.m_final.insert(new_final.begin(), new_final.end());
+        map.m_final |= new_final;
+        map.m_wildcard_final |= new_wildcard_final;
+        map.touch();
+        if (failed)
+            return false;
+
+        if (defaults)
+            store_defaults(desc, map, source);
+        return true;
+    }
+
+    namespace {
 
-        // Second, apply default values and store required options.
-        const vector<std::shared_ptr<OptionDescription> >& all = desc.options();
-        for(auto var : all)
+        /* One option of a parallel store: its occurrences in order and
+           what converting them gave. */
+        struct store_slot
         {
-            const OptionDescription& d = *var;
-            string key = d.key("");
-            if (key.empty())
+            store_slot(const OptionDescription* xd, const option_sets& xsets,
+                       const string& xkey)
+            : d(xd), sets(xsets), key(xkey), chunk_begin(0), chunk_end(0),
+              present(false), failed(0)
+            {}
+
+            const OptionDescription* d;
+            option_sets sets;
+            string key;
+            // Indices into ParsedOptions::entries.
+            vector<size_t> occurrences;
+            // Its chunks, in the order of the occurrences they cover.
+            size_t chunk_begin, chunk_end;
+            VariableValue value;
+            bool present;
+            // One past the entry that failed, or 0.
+            size_t failed;
+            exception_ptr exception;
+            vector<pair<ParseObserver::time_point, ParseObserver::time_point> > times;
+        };
+
+        /* Part of the occurrences of a built-in vector, converted on
+           its own: either occurrences [first, last) of a composing one,
+           or values [from, from + count) of the single long occurrence
+           'first'. */
+        struct store_chunk
+        {
+            const OptionDescription* d;
+            size_t first, last;
+            bool piece;
+            size_t from, count;
+            VariableValue value;
+            bool valid;
+            // As store_slot::failed.
+            size_t failed;
+            vector<pair<ParseObserver::time_point, ParseObserver::time_point> > times;
+        };
+
+        // Parses with fewer values are stored on the calling thread.
+        const size_t parallel_store_values = 4096;
+        // About how many values one chunk converts.
+        const size_t store_chunk_values = 4096;
+
+        /* Splits the occurrences of 's', a built-in vector, into
+           chunks. Only a composing option has its short occurrences
+           grouped, since any other starts over at each one. */
+        void split_slot(const ParsedOptions& options, store_slot& s,
+                        vector<store_chunk>& chunks)
+        {
+            s.chunk_begin = chunks.size();
+            store_chunk c;
+            c.d = s.d;
+            c.piece = false;
+            c.from = c.count = 0;
+            c.valid = false;
+            c.failed = 0;
+
+            const size_t none = size_t(-1);
+            size_t run = none, run_values = 0;
+            for (size_t k = 0; k <= s.occurrences.size(); ++k)
             {
-                continue;
+                size_t n = k < s.occurrences.size() ?
+                    options.entries[s.occurrences[k]].values : 0;
+                bool whole = k < s.occurrences.size() &&
+                             n <= store_chunk_values && s.d->is_composing();
+                if (run != none && (!whole || run_values >= store_chunk_values))
+                {
+                    c.first = run;
+                    c.last = k;
+                    chunks.push_back(c);
+                    run = none;
+                    run_values = 0;
+                }
+                if (whole)
+                {
+                    if (run == none)
+                        run = k;
+                    run_values += n;
+                }
+                else if (n > store_chunk_values)
+                {
+                    store_chunk piece = c;
+                    piece.first = k;
+                    piece.last = k + 1;
+                    piece.piece = true;
+                    for (size_t from = 0; from < n; from += store_chunk_values)
+                    {
+                        piece.from = from;
+                        piece.count = std::min(store_chunk_values, n - from);
+                        chunks.push_back(piece);
+                    }
+                }
             }
-            if (m.count(key) == 0) {
-            
-                Any def;
-                if (d.semantic()->apply_default(def)) {
-                    m[key] = VariableValue(def, true);
-                    m[key].m_value_semantic = d.semantic();
+            s.chunk_end = chunks.size();
+        }
+
+        void convert_chunk(const ParsedOptions& options, const store_slot& s,
+                           store_chunk& c, bool checked, bool timed)
+        {
+            vector<string> values;
+            ParseObserver::time_point start;
+            if (c.piece)
+            {
+                const ParsedOptions::entry& e = options.entries[s.occurrences[c.first]];
+                values.resize(c.count);
+                for (size_t k = 0; k < c.count; ++k)
+                {
+                    size_t t = e.first + 1 + c.from + k;
+                    values[k].assign(options.tokens.token(t),
+                                     options.tokens.length(t));
                 }
-            }  
+                if (timed)
+                    start = detail::now();
+                c.valid = detail::parse_builtin(c.d->builtin_kind(),
+                                                c.value.value(), values, checked) &&
+                          !c.value.empty();
+                if (timed)
+                    c.times.push_back(std::make_pair(start, detail::now()));
+                return;
+            }
+
+            for (size_t k = c.first; k < c.last; ++k)
+            {
+                size_t i = s.occurrences[k];
+                options.values(i, values);
+                if (timed)
+                    start = detail::now();
+                bool valid = convert(*c.d, &c.value, values, false, checked);
+                if (timed)
+                    c.times.push_back(std::make_pair(start, detail::now()));
+                if (!valid && checked)
+                {
+                    c.failed = i + 1;
+                    return;
+                }
+            }
+            c.valid = true;
+        }
+
+        /* Converts the occurrences of 's' in order into s.value, as
+           store_options() would, taking the chunks' results where they
+           cover them. Bound options are left to the caller. */
+        void convert_slot(const ParsedOptions& options, store_slot& s,
+                          vector<store_chunk>& chunks, bool checked,
+                          bool timed)
+        {
+            const OptionDescription& d = *s.d;
+            const int kind = d.builtin_kind();
+            VariableValue& v = s.value;
+            vector<string> values;
+            size_t c = s.chunk_begin;
+            size_t i = 0;
+            try {
+                for (size_t k = 0; k < s.occurrences.size(); )
+                {
+                    i = s.occurrences[k];
+                    if (v.isDefaulted() || !d.is_composing())
+                        v = VariableValue();
+
+                    bool valid = true;
+                    if (c < s.chunk_end && chunks[c].first == k && !chunks[c].piece)
+                    {
+                        store_chunk& run = chunks[c++];
+                        if (run.failed)
+                        {
+                            s.failed = run.failed;
+                            return;
+                        }
+                        if (!run.value.empty())
+                            detail::append_builtin(kind, v.value(), run.value.value());
+                        s.times.insert(s.times.end(), run.times.begin(), run.times.end());
+                        k = run.last;
+                    }
+                    else if (c < s.chunk_end && chunks[c].first == k)
+                    {
+                        // An invalid piece drops the whole occurrence, as
+                        // one invalid element drops a vector.
+                        size_t end = c;
+                        for (; end < s.chunk_end && chunks[end].first == k; ++end)
+                            valid = valid && chunks[end].valid;
+                        if (valid)
+                            for (size_t p = c; p < end; ++p)
+                                detail::append_builtin(kind, v.value(),
+                                                       chunks[p].value.value());
+                        if (timed)
+                        {
+                            pair<ParseObserver::time_point, ParseObserver::time_point>
+                                t = chunks[c].times.front();
+                            for (size_t p = c; p < end; ++p)
+                            {
+                                t.first = std::min(t.first, chunks[p].times.front().first);
+                                t.second = std::max(t.second, chunks[p].times.front().second);
+                            }
+                            s.times.push_back(t);
+                        }
+                        c = end;
+                        ++k;
+                    }
+                    else
+                    {
+                        options.values(i, values);
+                        ParseObserver::time_point start;
+                        if (timed)
+                            start = detail::now();
+                        valid = convert(d, &v, values, false, checked);
+                        if (timed)
+                            s.times.push_back(std::make_pair(start, detail::now()));
+                        ++k;
+                    }
+
+                    if (!valid && checked)
+                    {
+                        s.failed = i + 1;
+                        return;
+                    }
+                    if (!v.empty())
+                        s.present = true;
+                }
+            } catch (...) {
+                s.exception = std::current_exception();
+                s.failed = i + 1;
+            }
+        }
+    }
+
+    /* As store_options(), with the names resolved here, the values
+       converted on up to 'threads' threads, one option per task with
+       built-in vectors split further, and the results merged here in the
+       order the options first appear. The map is left alone unless
+       every value was converted; bound variables are written here,
+       last. */
+    static bool store_options_parallel(const ParsedOptions& options,
+                                       VariablesMap& map, unsigned threads,
+                                       Parse_error* error)
+    {
+        assert(options.description);
+
+        if (!threads)
+            threads = detail::hardware_threads();
+        size_t total = 0;
+        for (const auto& e : options.entries)
+            total += e.values;
+        if (threads < 2 || total < parallel_store_values)
+            return store_options(options, map, error);
+
+        const OptionsDescription& desc = *options.description;
+        std::map<std::string, VariableValue>& m = map;
+        ParseObserver* observer = detail::observer();
+        const bool checked = error != 0;
+
+        // An ambiguous name stops the store before anything converts.
+        vector<store_slot> slots;
+        // By id, wildcard keys apart.
+        std::unordered_map<uint64_t, size_t> slot_of;
+        string option_name;
+        Parse_error ambiguity;
+        for (size_t i = 0; i < options.size(); ++i)
+        {
+            const ParsedOptions::entry& var = options.entries[i];
+            if (!options.key_length(i) || var.unregistered)
+                continue;
+
+            option_name.assign(options.key(i), options.key_length(i));
+            const OptionDescription* d = desc.find_nothrow(option_name,
+                                                    var.has_value, false, false,
+                                                    &ambiguity);
+            if (ambiguity)
+            {
+                ambiguity.token_index = var.token_index;
+                if (!error)
+                    throw Options_error(ambiguity);
+                *error = std::move(ambiguity);
+                return false;
+            }
+            if (!d)
+                continue;
+
+            const string key = d->key(option_name);
+            option_sets sets(map, *d, key);
+            if (sets.final->test(sets.id))
+                continue;
+
+            auto found = slot_of.emplace(uint64_t(sets.wildcard) << 32 | sets.id,
+                                         slots.size());
+            if (found.second)
+                slots.push_back(store_slot(d, sets, key));
+            slots[found.first->second].occurrences.push_back(i);
+        }
+
+        vector<store_chunk> chunks;
+        vector<size_t> tasks;
+        for (size_t k = 0; k < slots.size(); ++k)
+        {
+            store_slot& s = slots[k];
+            if (s.d->is_bind_only())
+                continue;
+            tasks.push_back(k);
+
+            // Copied, so that a failed store leaves the map as it was.
+            if (s.d->is_composing())
+            {
+                std::map<std::string, VariableValue>::const_iterator
+                    existing = m.find(s.key);
+                if (existing != m.end() && !existing->second.isDefaulted())
+                    s.value = existing->second;
+            }
+
+            if (detail::is_builtin_vector(s.d->builtin_kind()))
+                split_slot(options, s, chunks);
+        }
 
-            // add empty value if this is an required option
-            if (d.semantic()->is_required()) {
-                string canonical_name = d.canonical_display_name(options.m_options_prefix);
-                if (canonical_name.length() > map.m_required[key].length())
-                    map.m_required[key] = canonical_name;
+        vector<size_t> chunk_slot(chunks.size());
+        for (size_t k = 0; k < slots.size(); ++k)
+            for (size_t c = slots[k].chunk_begin; c < slots[k].chunk_end; ++c)
+                chunk_slot[c] = k;
+        detail::parallel_for(chunks.size(), threads, [&](size_t k) {
+            convert_chunk(options, slots[chunk_slot[k]], chunks[k],
+                          checked, observer != 0);
+        });
+
+        detail::parallel_for(tasks.size(), threads, [&](size_t k) {
+            convert_slot(options, slots[tasks[k]], chunks, checked, observer != 0);
+        });
+
+        // The earliest failure is the one a plain store would have met.
+        const store_slot* failed = 0;
+        for (const auto& s : slots)
+            if (s.failed && (!failed || s.failed < failed->failed))
+                failed = &s;
+        if (failed && failed->exception)
+            rethrow_exception(failed->exception);
+        if (failed)
+        {
+            vector<string> values;
+            const size_t i = failed->failed - 1;
+            options.values(i, values);
+            *error = Parse_error(Parse_error::invalid_value,
+                                 options.entries[i].token_index, joined(values));
+            error->option = failed->key;
+            return false;
+        }
+
+        detail::Id_set new_final, new_wildcard_final;
+        bool valid = true;
+        for (auto& s : slots)
+        {
+            const OptionDescription& d = *s.d;
+            const Value_semantic& semantic = d.value_semantic();
+            if (d.is_bind_only())
+            {
+                vector<string> values;
+                for (size_t i : s.occurrences)
+                {
+                    options.values(i, values);
+                    ParseObserver::time_point start;
+                    if (observer)
+                        start = detail::now();
+                    valid = convert(d, 0, values, s.sets.fresh(), checked);
+                    if (observer)
+                        observer->value_converted(s.key, semantic,
+                                                  start, detail::now());
+                    if (!valid && error)
+                    {
+                        *error = Parse_error(Parse_error::invalid_value,
+                                             options.entries[i].token_index,
+                                             joined(values));
+                        error->option = s.key;
+                        break;
+                    }
+                    if (valid)
+                        s.sets.given();
+                }
+                if (!valid && error)
+                    break;
+            }
+            else
+            {
+                for (const auto& t : s.times)
+                    observer->value_converted(s.key, semantic, t.first, t.second);
+                VariableValue& v = m[s.key];
+                v = std::move(s.value);
+                if (v.m_value_semantic.get() != &semantic)
+                    v.m_value_semantic = d.semantic();
+                v.m_source = 0;
+                v.m_position = position_of(options, s.occurrences.back());
+                if (s.present)
+                    s.sets.given();
             }
+            if (!d.is_composing())
+                (s.sets.wildcard ? new_wildcard_final : new_final).set(s.sets.id);
         }
 
+        map.m_final |= new_final;
+        map.m_wildcard_final |= new_wildcard_final;
+        map.touch();
+        if (!valid && error)
+            return false;
+
+        store_defaults(desc, map, 0);
+        return true;
+    }
+
+    /* store_options() on each source in turn, then the defaults of each
+       of their descriptions once. */
+    static bool store_all(const vector<const ParsedOptions*>& sources,
+                          VariablesMap& map, Parse_error* error)
+    {
+        assert(sources.size() < 0xFFFF);
+
+        for (std::size_t k = 0; k < sources.size(); ++k)
+            if (!store_options(*sources[k], map, error,
+                               static_cast<unsigned>(k), false))
+                return false;
+
+        vector<const OptionsDescription*> done;
+        for (const ParsedOptions* source : sources)
+        {
+            if (std::find(done.begin(), done.end(), source->description) != done.end())
+                continue;
+            done.push_back(source->description);
+            store_defaults(*source->description, map,
+                           static_cast<unsigned>(sources.size()));
+        }
+
+        Parse_error broken;
+        for (const OptionsDescription* desc : done)
+            if (!desc->constraints().check(desc->key_ids(), map.m_present, map.m_defaulted, broken))
+            {
+                if (!error)
+                    throw Options_error(broken);
+                *error = std::move(broken);
+                return false;
+            }
+        return true;
+    }
+
+    void store(const ParsedOptions& options, VariablesMap& map)
+    {
+        store_options(options, map, 0);
+    }
+
+    Expected<void> try_store(const ParsedOptions& options, VariablesMap& map)
+    {
+        Parse_error error;
+        if (!store_options(options, map, &error))
+            return Expected<void>(std::move(error));
+        return Expected<void>();
+    }
+
+    void store_parallel(const ParsedOptions& options, VariablesMap& map,
+                        unsigned threads)
+    {
+        store_options_parallel(options, map, threads, 0);
+    }
+
+    Expected<void> try_store_parallel(const ParsedOptions& options,
+                                      VariablesMap& map, unsigned threads)
+    {
+        Parse_error error;
+        if (!store_options_parallel(options, map, threads, &error))
+            return Expected<void>(std::move(error));
+        return Expected<void>();
     }
      
+    void store_sources(const vector<const ParsedOptions*>& sources,
+                       VariablesMap& map)
+    {
+        store_all(sources, map, 0);
+    }
+
+    Expected<void> try_store_sources(const vector<const ParsedOptions*>& sources,
+                                     VariablesMap& map)
+    {
+        Parse_error error;
+        if (!store_all(sources, map, &error))
+            return Expected<void>(std::move(error));
+        return Expected<void>();
+    }
+
+    void check_constraints(const VariablesMap& map, const OptionsDescription& desc)
+    {
+        Expected<void> checked = try_check_constraints(map, desc);
+        if (!checked)
+            throw Options_error(checked.error());
+    }
+
+    Expected<void> try_check_constraints(const VariablesMap& map,
+                                         const OptionsDescription& desc)
+    {
+        Parse_error error;
+        if (!desc.constraints().check(desc.key_ids(), map.m_present, map.m_defaulted, error))
+            return Expected<void>(std::move(error));
+        return Expected<void>();
+    }
+
     void notify(VariablesMap& vm)
     {        
         vm.notify();               
     }
 
     AbstractVariablesMap::AbstractVariablesMap()
-    : m_next(0)
+    : m_next(0), m_generation(0)
     {}
 
     AbstractVariablesMap::
     AbstractVariablesMap(const AbstractVariablesMap* next)
-    : m_next(next)
+    : m_next(next), m_generation(0)
     {}
 
     const VariableValue& 
@@ -121,9 +774,16 @@ namespace  options {
     }
 
     void 
-    AbstractVariablesMap::next(AbstractVariablesMap* next)
+    AbstractVariablesMap::next(const AbstractVariablesMap* next)
     {
         m_next = next;
+        touch();
+    }
+
+    FlatVariablesMap
+    AbstractVariablesMap::flatten() const
+    {
+        return FlatVariablesMap(*this);
     }
 
     VariablesMap::VariablesMap()
@@ -138,6 +798,20 @@ namespace  options {
         std::map<std::string, VariableValue>::clear();
         m_final.clear();
         m_required.clear();
+        m_present.clear();
+        m_defaulted.clear();
+        m_wildcard_ids.clear();
+        m_wildcard_final.clear();
+        m_wildcard_present.clear();
+        m_wildcard_defaulted.clear();
+        touch();
+    }
+
+    void
+    VariablesMap::names(std::vector<std::string>& result) const
+    {
+        for (const_iterator i = begin(); i != end(); ++i)
+            result.push_back(i->first);
     }
 
     const VariableValue&
@@ -154,20 +828,23 @@ namespace  options {
     void
     VariablesMap::notify()
     {
-        for (map<string, string>::const_iterator r = m_required.begin();
-             r != m_required.end();
-             ++r)
-        {
-            const string& opt = r->first;
-            const string& display_opt = r->second;
-            map<string, VariableValue>::const_iterator iter = find(opt);
-            if (iter == end() || iter->second.empty()) 
-            {
-                return ;
-            }
-        }
+        ParseObserver* observer = detail::observer();
+
+        // Only required options store() has not seen need a lookup, in
+        // case they were added through the std::map interface.
+        bool missing = false;
+        m_required.for_each_missing(m_present, [&](unsigned id) {
+            if (missing)
+                return;
+            map<string, VariableValue>::const_iterator iter =
+                find(detail::id_name(id));
+            if (iter == end() || iter->second.empty())
+                missing = true;
+        });
+        if (missing)
+            return;
 
-        for (map<string, VariableValue>::iterator k = begin(); 
+        for (map<string, VariableValue>::const_iterator k = begin(); 
              k != end(); 
              ++k) 
         {
@@ -179,7 +856,21 @@ namespace  options {
                not NULL. See:
                    https://svn.boost.org/trac/boost/ticket/2782
             */
-            if (k->second.m_value_semantic)
+            if (!k->second.m_value_semantic)
+                continue;
+            // A default nobody has read yet stays unread if unused.
+            if (k->second.v.empty() && k->second.m_default &&
+                k->second.m_default->pending() &&
+                !k->second.m_value_semantic->notifies())
+                continue;
+            if (observer)
+            {
+                ParseObserver::time_point start = detail::now();
+                k->second.m_value_semantic->notify(k->second.value());
+                observer->notify_called(k->first, *k->second.m_value_semantic,
+                                        start, detail::now());
+            }
+            else
                 k->second.m_value_semantic->notify(k->second.value());
         }               
     }
@@ -189,4 +880,71 @@ namespace  options {
     	return std::map<std::string, VariableValue>::count(name) >= 1;
     }
 
+    FlatVariablesMap::FlatVariablesMap()
+    : m_head(0)
+    {}
+
+    FlatVariablesMap::FlatVariablesMap(const AbstractVariablesMap& head)
+    : m_head(&head)
+    {
+        refresh();
+    }
+
+    const VariableValue&
+    FlatVariablesMap::operator[](const std::string& name) const
+    {
+        static VariableValue empty;
+        std::unordered_map<std::string, VariableValue>::const_iterator i =
+            m_values.find(name);
+        if (i == m_values.end())
+            return empty;
+        else
+            return i->second;
+    }
+
+    bool
+    FlatVariablesMap::has(const std::string& name) const
+    {
+        return m_values.count(name) != 0;
+    }
+
+    std::size_t
+    FlatVariablesMap::size() const
+    {
+        return m_values.size();
+    }
+
+    bool
+    FlatVariablesMap::stale() const
+    {
+        for (std::size_t i = 0; i < m_layers.size(); ++i)
+            if (m_layers[i].first->generation() != m_layers[i].second)
+                return true;
+        return false;
+    }
+
+    void
+    FlatVariablesMap::refresh()
+    {
+        m_layers.clear();
+        m_values.clear();
+
+        std::vector<std::string> all;
+        for (const AbstractVariablesMap* l = m_head; l; l = l->m_next)
+        {
+            m_layers.push_back(layer(l, l->generation()));
+            l->names(all);
+        }
+
+        m_values.reserve(all.size());
+        for (std::size_t i = 0; i < all.size(); ++i)
+        {
+            if (m_values.count(all[i]))
+                continue;
+            // Let the chain itself decide which layer wins, so the flat
+            // view can never disagree with operator[].
+            m_values.insert(std::make_pair(all[i], (*m_head)[all[i]]));
+        }
+    }
+
 }
@@ -0,0 +1,161 @@
+#include "program_options/VariablesMapPublisher.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace options {
+
+    using namespace std;
+
+    VariablesMapPublisher::Snapshot::Snapshot(slot* s, const VariablesMap* map)
+    : m_slot(s), m_map(map)
+    {}
+
+    VariablesMapPublisher::Snapshot::Snapshot(Snapshot&& other)
+    : m_slot(other.m_slot), m_map(other.m_map)
+    {
+        other.m_slot = 0;
+        other.m_map = 0;
+    }
+
+    VariablesMapPublisher::Snapshot::~Snapshot()
+    {
+        if (!m_slot)
+            return;
+        assert(m_slot->depth > 0);
+        if (--m_slot->depth == 0)
+            m_slot->epoch.store(0, memory_order_release);
+    }
+
+    VariablesMapPublisher::Subscriber::Subscriber(VariablesMapPublisher* owner,
+                                                  slot* s)
+    : m_owner(owner), m_slot(s)
+    {}
+
+    VariablesMapPublisher::Subscriber::Subscriber(Subscriber&& other)
+    : m_owner(other.m_owner), m_slot(other.m_slot)
+    {
+        other.m_owner = 0;
+        other.m_slot = 0;
+    }
+
+    VariablesMapPublisher::Subscriber::~Subscriber()
+    {
+        if (!m_slot)
+            return;
+        assert(m_slot->depth == 0);
+        m_slot->epoch.store(0, memory_order_release);
+        m_slot->used.store(false, memory_order_release);
+    }
+
+    VariablesMapPublisher::Snapshot
+    VariablesMapPublisher::Subscriber::read()
+    {
+        assert(m_slot);
+        if (m_slot->depth++ == 0)
+        {
+            // The announcement must be globally visible before the
+            // pointer is loaded; reclaim() relies on this ordering.
+            m_slot->epoch.store(m_owner->m_epoch.load(memory_order_seq_cst),
+                                memory_order_seq_cst);
+        }
+        return Snapshot(m_slot, m_owner->m_current.load(memory_order_seq_cst));
+    }
+
+    VariablesMapPublisher::VariablesMapPublisher(unsigned max_subscribers)
+    : m_current(new VariablesMap())
+    , m_epoch(1)
+    , m_slots(new slot[max_subscribers])
+    , m_slot_count(max_subscribers)
+    {
+        for (unsigned i = 0; i < m_slot_count; ++i)
+        {
+            m_slots[i].epoch.store(0, memory_order_relaxed);
+            m_slots[i].used.store(false, memory_order_relaxed);
+            m_slots[i].depth = 0;
+        }
+    }
+
+    VariablesMapPublisher::VariablesMapPublisher(
+        std::unique_ptr<const VariablesMap> initial, unsigned max_subscribers)
+    : VariablesMapPublisher(max_subscribers)
+    {
+        if (initial)
+            delete m_current.exchange(initial.release());
+    }
+
+    VariablesMapPublisher::~VariablesMapPublisher()
+    {
+        for (size_t i = 0; i < m_retired.size(); ++i)
+            delete m_retired[i].first;
+        delete m_current.load();
+    }
+
+    void
+    VariablesMapPublisher::publish(std::unique_ptr<const VariablesMap> next)
+    {
+        assert(next);
+        lock_guard<mutex> lock(m_writer);
+        const VariablesMap* old = m_current.exchange(next.release(),
+                                                     memory_order_seq_cst);
+        unsigned long retired_in = m_epoch.fetch_add(1, memory_order_seq_cst);
+        m_retired.push_back(make_pair(old, retired_in));
+        reclaim_locked();
+    }
+
+    void
+    VariablesMapPublisher::publish(const VariablesMap& next)
+    {
+        publish(std::unique_ptr<const VariablesMap>(new VariablesMap(next)));
+    }
+
+    VariablesMapPublisher::Subscriber
+    VariablesMapPublisher::subscribe()
+    {
+        for (unsigned i = 0; i < m_slot_count; ++i)
+        {
+            bool expected = false;
+            if (!m_slots[i].used.load(memory_order_relaxed) &&
+                m_slots[i].used.compare_exchange_strong(expected, true,
+                                                        memory_order_acq_rel))
+                return Subscriber(this, &m_slots[i]);
+        }
+        throw std::length_error("VariablesMapPublisher: too many subscribers");
+    }
+
+    std::size_t
+    VariablesMapPublisher::reclaim()
+    {
+        lock_guard<mutex> lock(m_writer);
+        return reclaim_locked();
+    }
+
+    std::size_t
+    VariablesMapPublisher::reclaim_locked()
+    {
+        if (m_retired.empty())
+            return 0;
+
+        // A reader that announced epoch e may hold any snapshot retired
+        // in epoch e or later.
+        unsigned long oldest = 0;
+        for (unsigned i = 0; i < m_slot_count; ++i)
+        {
+            unsigned long e = m_slots[i].epoch.load(memory_order_seq_cst);
+            if (e != 0 && (oldest == 0 || e < oldest))
+                oldest = e;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < m_retired.size(); ++i)
+        {
+            if (oldest == 0 || m_retired[i].second < oldest)
+                delete m_retired[i].first;
+            else
+                m_retired[kept++] = m_retired[i];
+        }
+        m_retired.resize(kept);
+        return kept;
+    }
+
+}
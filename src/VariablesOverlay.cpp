@@ -0,0 +1,124 @@
+#include "program_options/VariablesOverlay.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace options {
+
+    using namespace std;
+
+    namespace {
+
+        bool name_less(const VariablesOverlay::override_type& a,
+                       const VariablesOverlay::override_type& b)
+        {
+            return a.first < b.first;
+        }
+
+        bool name_before(const VariablesOverlay::override_type& a,
+                         const std::string& name)
+        {
+            return a.first < name;
+        }
+
+        bool name_equal(const VariablesOverlay::override_type& a,
+                        const VariablesOverlay::override_type& b)
+        {
+            return a.first == b.first;
+        }
+    }
+
+    VariablesOverlay::VariablesOverlay(std::shared_ptr<const VariablesMap> base)
+    : AbstractVariablesMap(static_cast<const AbstractVariablesMap*>(base.get()))
+    , m_base(base)
+    {
+        assert(m_base);
+    }
+
+    VariablesOverlay::VariablesOverlay(std::shared_ptr<const VariablesMap> base,
+                                       std::vector<override_type> overrides)
+    : AbstractVariablesMap(static_cast<const AbstractVariablesMap*>(base.get()))
+    , m_base(base)
+    , m_overrides(std::move(overrides))
+    {
+        assert(m_base);
+        // Later entries win, as if set() had been called for each in turn.
+        std::stable_sort(m_overrides.begin(), m_overrides.end(), name_less);
+        std::reverse(m_overrides.begin(), m_overrides.end());
+        m_overrides.erase(std::unique(m_overrides.begin(), m_overrides.end(),
+                                      name_equal),
+                          m_overrides.end());
+        std::reverse(m_overrides.begin(), m_overrides.end());
+    }
+
+    VariablesOverlay&
+    VariablesOverlay::set(const std::string& name, const VariableValue& v)
+    {
+        vector<override_type>::iterator i =
+            std::lower_bound(m_overrides.begin(), m_overrides.end(), name, name_before);
+        if (i != m_overrides.end() && i->first == name)
+            i->second = v;
+        else
+            m_overrides.insert(i, override_type(name, v));
+        touch();
+        return *this;
+    }
+
+    VariablesOverlay&
+    VariablesOverlay::set(const std::string& name, const Any& v)
+    {
+        return set(name, VariableValue(v, false));
+    }
+
+    bool
+    VariablesOverlay::erase(const std::string& name)
+    {
+        vector<override_type>::const_iterator i = lookup(name);
+        if (i == m_overrides.end())
+            return false;
+        m_overrides.erase(m_overrides.begin() + (i - m_overrides.begin()));
+        touch();
+        return true;
+    }
+
+    bool
+    VariablesOverlay::has(const std::string& name) const
+    {
+        return overrides(name) || m_base->has(name);
+    }
+
+    bool
+    VariablesOverlay::overrides(const std::string& name) const
+    {
+        return lookup(name) != m_overrides.end();
+    }
+
+    const VariableValue&
+    VariablesOverlay::get(const std::string& name) const
+    {
+        static VariableValue empty;
+        vector<override_type>::const_iterator i = lookup(name);
+        if (i == m_overrides.end())
+            return empty;
+        else
+            return i->second;
+    }
+
+    void
+    VariablesOverlay::names(std::vector<std::string>& result) const
+    {
+        for (size_t i = 0; i < m_overrides.size(); ++i)
+            result.push_back(m_overrides[i].first);
+    }
+
+    std::vector<VariablesOverlay::override_type>::const_iterator
+    VariablesOverlay::lookup(const std::string& name) const
+    {
+        vector<override_type>::const_iterator i =
+            std::lower_bound(m_overrides.begin(), m_overrides.end(), name, name_before);
+        if (i != m_overrides.end() && i->first == name)
+            return i;
+        return m_overrides.end();
+    }
+
+}
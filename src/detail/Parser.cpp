@@ -3,17 +3,33 @@
 #include "program_options/Parsers.hpp"
 #include <iterator>
 #include "program_options/OptionEnum.h"
+#include "program_options/detail/Utf8.hpp"
 
 namespace options {
 
     namespace detail {
-        template<class charT, class Iterator>
-        std::vector<std::basic_string<charT> >
-        make_vector(Iterator i, Iterator e)
+        inline void
+        append_utf8(std::vector<std::string>& result, const std::wstring& s)
         {
-            std::vector<std::basic_string<charT> > result;
+            result.push_back(std::string());
+            to_utf8(s.data(), s.size(), result.back());
+        }
+
+        inline void
+        append_utf8(std::vector<std::string>& result, const wchar_t* s)
+        {
+            result.push_back(std::string());
+            to_utf8(s, std::char_traits<wchar_t>::length(s), result.back());
+        }
+
+        template<class Iterator>
+        std::vector<std::string>
+        make_utf8_vector(Iterator i, Iterator e)
+        {
+            std::vector<std::string> result;
+            result.reserve(std::distance(i, e));
             for(; i != e; ++i)
-                result.push_back(*i);
+                append_utf8(result, *i);
             return result;
         }
     }
@@ -25,12 +41,28 @@ namespace options {
 
     Basic_command_line_parser::
 	Basic_command_line_parser(int argc, const char* const argv[])
-        : detail::Cmdline(
-                      detail::make_vector<char, const char* const*>(argv+1, argv+argc+!argc))
+        : detail::Cmdline(TokenBuffer(argc ? argc-1 : 0, argv+1))
 	{
 
 	}
 
+    Basic_command_line_parser::
+    Basic_command_line_parser(TokenBuffer args)
+       : detail::Cmdline(std::move(args))
+    {}
+
+    Basic_command_line_parser::
+    Basic_command_line_parser(const std::vector<std::wstring>& xargs)
+       : detail::Cmdline(
+                      detail::make_utf8_vector(xargs.begin(), xargs.end()))
+    {}
+
+    Basic_command_line_parser::
+    Basic_command_line_parser(int argc, const wchar_t* const argv[])
+       : detail::Cmdline(
+                      detail::make_utf8_vector(argv+1, argv+argc+!argc))
+    {}
+
 	Basic_command_line_parser&
 	Basic_command_line_parser::options(const OptionsDescription& desc)
 	{
@@ -50,9 +82,20 @@ namespace options {
     Basic_command_line_parser::run()
     {
         ParsedOptions result(m_desc, 0);
-        result.options = detail::Cmdline::run();
+        detail::Cmdline::run(result);
 
-        return ParsedOptions(result);
+        return result;
+    }
+
+    Expected<ParsedOptions>
+    Basic_command_line_parser::try_run()
+    {
+        Parse_error error;
+        ParsedOptions result(m_desc, 0);
+        detail::Cmdline::run(result, &error);
+        if (error)
+            return Expected<ParsedOptions>(std::move(error));
+        return Expected<ParsedOptions>(std::move(result));
     }
 
     std::vector< std::basic_string<char> >
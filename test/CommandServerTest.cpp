@@ -0,0 +1,141 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+#include <unistd.h>
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+namespace {
+
+	// A pipe holding 'text', with the writing end closed.
+	int pipe_with(const string& text)
+	{
+		int fds[2];
+		if (pipe(fds) != 0)
+			return -1;
+		if (write(fds[1], text.data(), text.size()) != static_cast<ssize_t>(text.size()))
+			return -1;
+		close(fds[1]);
+		return fds[0];
+	}
+}
+
+FIXTURE(CommandServerTest)
+{
+	TEST("each line should be parsed into a fresh map")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("verbose,v", "be verbose")
+									("level", value<int>(), "set level")
+									("name", value<string>(), "set name");
+
+		int fd = pipe_with("--level=3 --name='a b'\r\n\n--level=x\n-v");
+		ASSERT_THAT(fd >= 0, is(true));
+
+		vector<string> seen;
+		CommandServer server(desc);
+		size_t lines = server.serve(fd, [&](const VariablesMap& vm, const Parse_error& e) {
+			if (e)
+				seen.push_back("error " + e.option);
+			else if (vm.has("level"))
+				seen.push_back(to_string(any_cast<int>(vm["level"].value())) + " " +
+				               any_cast<string>(vm["name"].value()));
+			else
+				seen.push_back(vm.has("verbose") ? "verbose" : "");
+			return true;
+		});
+		close(fd);
+
+		ASSERT_THAT(lines, is(3u));
+		ASSERT_THAT(seen.size(), is(3u));
+		ASSERT_THAT(seen[0], is(string("3 a b")));
+		ASSERT_THAT(seen[1], is(string("error level")));
+		ASSERT_THAT(seen[2], is(string("verbose")));
+	}
+
+	TEST("nul delimited lines may hold newlines and the handler may stop")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("name", value<string>(), "set name");
+
+		int fd = pipe_with(string("--name='x\ny'\0--name=z\0--name=w\0", 30));
+		ASSERT_THAT(fd >= 0, is(true));
+
+		vector<string> seen;
+		CommandServer server(desc, '\0');
+		size_t lines = server.serve(fd, [&](const VariablesMap& vm, const Parse_error&) {
+			seen.push_back(any_cast<string>(vm["name"].value()));
+			return seen.size() < 2;
+		});
+		close(fd);
+
+		ASSERT_THAT(lines, is(2u));
+		ASSERT_THAT(seen[0], is(string("x\ny")));
+		ASSERT_THAT(seen[1], is(string("z")));
+	}
+
+	TEST("entries should be reused from line to line without leaking values")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level", value<int>(), "set level")
+									("format", value<string>()->default_value("text"), "set format")
+									("include", value< vector<string> >()->composing(), "add include");
+
+		int fd = pipe_with("--level=1 --include=a\n--include=b\n--format=json\n");
+		ASSERT_THAT(fd >= 0, is(true));
+
+		vector<string> seen;
+		vector<const VariableValue*> format;
+		CommandServer server(desc);
+		server.serve(fd, [&](const VariablesMap& vm, const Parse_error&) {
+			string line = any_cast<string>(vm["format"].value());
+			line += vm.has("level") ? " level" : "";
+			if (vm.has("include"))
+				for (const string& i : any_cast< vector<string> >(vm["include"].value()))
+					line += " " + i;
+			seen.push_back(line);
+			format.push_back(&vm.find("format")->second);
+			return true;
+		});
+		close(fd);
+
+		ASSERT_THAT(seen.size(), is(3u));
+		ASSERT_THAT(seen[0], is(string("text level a")));
+		ASSERT_THAT(seen[1], is(string("text b")));
+		ASSERT_THAT(seen[2], is(string("json")));
+		ASSERT_THAT(format[0] == format[1] && format[1] == format[2], is(true));
+	}
+
+	TEST("a line longer than the limit should be reported and skipped")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("name", value<string>(), "set name");
+
+		int fd = pipe_with("--name=a\n--name=" + string(30000, 'x') + "\n--name=b");
+		ASSERT_THAT(fd >= 0, is(true));
+
+		vector<string> seen;
+		CommandServer server(desc, '\n', 16);
+		size_t lines = server.serve(fd, [&](const VariablesMap& vm, const Parse_error& e) {
+			if (e)
+				seen.push_back(e.kind == Parse_error::invalid_syntax && vm.empty() ?
+				               e.message() : "");
+			else
+				seen.push_back(any_cast<string>(vm["name"].value()));
+			return true;
+		});
+		close(fd);
+
+		ASSERT_THAT(lines, is(3u));
+		ASSERT_THAT(seen[0], is(string("a")));
+		ASSERT_THAT(seen[1], is(string("syntax error: line longer than 16 bytes")));
+		ASSERT_THAT(seen[2], is(string("b")));
+	}
+};
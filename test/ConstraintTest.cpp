@@ -0,0 +1,125 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(ConstraintTest)
+{
+	OptionsDescription desc;
+
+	SETUP()
+	{
+		desc.add_options()("input", value<string>(), "read input")
+						("stdin", "read standard input")
+						("output", value<string>(), "write output")
+						("format", value<string>()->default_value("text"), "set format")
+						("verbose", "be verbose")
+						("quiet", "be quiet");
+		desc.one_of({"input", "stdin"})
+			.conflicts({"verbose", "quiet"})
+			.depends("output", {"format"})
+			.at_least_one({"output", "verbose", "quiet"});
+	}
+
+	Parse_error check(const vector<string>& args)
+	{
+		VariablesMap vm;
+		store(command_line_parser(args).options(desc).run(), vm);
+		return try_check_constraints(vm, desc).error();
+	}
+
+	TEST("constraints should accept command lines that keep every rule")
+	{
+		ASSERT_THAT(bool(check({"--input=a", "--quiet"})), is(false));
+		ASSERT_THAT(bool(check({"--stdin", "--output=b", "--format=json"})), is(false));
+	}
+
+	TEST("constraints should report the first broken rule with the options involved")
+	{
+		Parse_error both = check({"--input=a", "--stdin", "--quiet"});
+		ASSERT_THAT(both.kind == Parse_error::conflicting_options, is(true));
+		ASSERT_THAT(both.candidates, is(vector<string>({"input", "stdin"})));
+		ASSERT_THAT(both.option, is(string("stdin")));
+		ASSERT_THAT(both.message(),
+		            is(string("the options 'input' and 'stdin' cannot be used together")));
+
+		Parse_error neither = check({"--quiet"});
+		ASSERT_THAT(neither.kind == Parse_error::missing_one_of, is(true));
+		ASSERT_THAT(neither.message(),
+		            is(string("one of the options 'input' or 'stdin' is required")));
+
+		Parse_error loud = check({"--stdin", "--verbose", "--quiet"});
+		ASSERT_THAT(loud.kind == Parse_error::conflicting_options, is(true));
+
+		// A default does not satisfy a dependency.
+		Parse_error alone = check({"--stdin", "--output=b"});
+		ASSERT_THAT(alone.kind == Parse_error::missing_dependency, is(true));
+		ASSERT_THAT(alone.option, is(string("output")));
+		ASSERT_THAT(alone.token, is(string("format")));
+		ASSERT_THAT(alone.message(), is(string("option 'output' requires option 'format'")));
+
+		Parse_error silent = check({"--stdin"});
+		ASSERT_THAT(silent.kind == Parse_error::missing_one_of, is(true));
+		ASSERT_THAT(silent.candidates.size(), is(3u));
+	}
+
+	TEST("parsing and merging sources should check the constraints of the description")
+	{
+		const char* argv[] = {"", "--input=a", "--stdin", "--quiet"};
+		Expected<VariablesMap> parsed = try_parse_args(4, argv, desc);
+		ASSERT_THAT(parsed.error().kind == Parse_error::conflicting_options, is(true));
+
+		bool thrown = false;
+		try {
+			parse_args(4, argv, desc);
+		} catch (const Options_error& e) {
+			thrown = e.error.kind == Parse_error::conflicting_options;
+		}
+		ASSERT_THAT(thrown, is(true));
+
+		// Each source alone breaks a rule the merged map keeps.
+		vector<string> args = {"--output=b"};
+		ParsedOptions cmdline = command_line_parser(args).options(desc).run();
+		args = {"--stdin", "--format=json"};
+		ParsedOptions config = command_line_parser(args).options(desc).run();
+		VariablesMap vm;
+		ASSERT_THAT(bool(try_store_sources({&cmdline, &config}, vm)), is(true));
+
+		OptionsDescription outer;
+		outer.add(desc);
+		ASSERT_THAT(try_check_constraints(vm, outer).error().kind == Parse_error::none, is(true));
+		VariablesMap empty;
+		ASSERT_THAT(try_check_constraints(empty, outer).error().kind ==
+		            Parse_error::missing_one_of, is(true));
+	}
+
+	TEST("a rule naming an unknown option should be reported whatever was given")
+	{
+		OptionsDescription typo;
+		typo.add_options()("verbose", "be verbose")
+						  ("quiet", "be quiet");
+		typo.conflicts({"verbose", "quite"});
+
+		vector<string> args = {"--verbose"};
+		VariablesMap vm;
+		store(command_line_parser(args).options(typo).run(), vm);
+		Parse_error unknown = try_check_constraints(vm, typo).error();
+		ASSERT_THAT(unknown.kind == Parse_error::unknown_rule_option, is(true));
+		ASSERT_THAT(unknown.token, is(string("quite")));
+		ASSERT_THAT(unknown.message(),
+		            is(string("a rule names 'quite', which is not an option")));
+
+		OptionsDescription subject;
+		subject.add_options()("output", value<string>(), "write output");
+		subject.depends("ouptut", {"output"});
+		VariablesMap empty;
+		ASSERT_THAT(try_check_constraints(empty, subject).error().token,
+		            is(string("ouptut")));
+	}
+};
@@ -0,0 +1,203 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+namespace {
+	struct file_observer : ParseObserver
+	{
+		void file_loaded(const string& path, time_point start, time_point end)
+		{
+			size_t slash = path.rfind('/');
+			files.push_back(path.substr(slash + 1) + (start <= end ? "" : " backwards"));
+		}
+
+		vector<string> files;
+	};
+
+	/* A scratch directory, removed with the files written to it. */
+	struct config_dir
+	{
+		config_dir()
+		{
+			char name[] = "/tmp/options_configXXXXXX";
+			path = mkdtemp(name);
+		}
+
+		~config_dir()
+		{
+			for (const auto& f : written)
+				remove(f.c_str());
+			for (auto d = dirs.rbegin(); d != dirs.rend(); ++d)
+				rmdir(d->c_str());
+			rmdir(path.c_str());
+		}
+
+		string write(const string& name, const string& text)
+		{
+			string file = path + "/" + name;
+			ofstream(file.c_str()) << text;
+			written.push_back(file);
+			return file;
+		}
+
+		void mkdir(const string& name)
+		{
+			dirs.push_back(path + "/" + name);
+			::mkdir(dirs.back().c_str(), 0700);
+		}
+
+		string path;
+		vector<string> written, dirs;
+	};
+}
+
+FIXTURE(JsonConfigTest)
+{
+	TEST("nested members should be stored under their dotted path")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("server.host", value<string>(), "set host")
+									("server.ports", value< vector<int> >()->multitoken(), "set ports")
+									("server.tls.enabled", "use tls")
+									("verbose", "be verbose")
+									("name", value<string>(), "set name");
+
+		istringstream json(
+			"{ \"server\": { \"host\": \"example.org\", \"ports\": [80, [443]],\n"
+			"              \"tls\": {\"enabled\": true}, \"unknown\": {\"x\": 1} },\n"
+			"  \"verbose\": false,\n"
+			"  \"name\": \"caf\\u00e9 \\\"\\ud83d\\ude00\\\"\" }");
+
+		VariablesMap vm;
+		store(parse_json_config(json, desc), vm);
+
+		ASSERT_THAT(any_cast<string>(vm["server.host"].value()), is(string("example.org")));
+		ASSERT_THAT(any_cast< vector<int> >(vm["server.ports"].value()).size(), is(2u));
+		ASSERT_THAT(any_cast< vector<int> >(vm["server.ports"].value())[1], is(443));
+		ASSERT_THAT(vm.has("server.tls.enabled"), is(true));
+		ASSERT_THAT(vm.has("verbose"), is(false));
+		ASSERT_THAT(any_cast<string>(vm["name"].value()),
+		            is(string("caf\xc3\xa9 \"\xf0\x9f\x98\x80\"")));
+	}
+
+	TEST("malformed json should be reported with its byte offset")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level", value<int>(), "set level");
+
+		istringstream json("{\"level\": 3,\n \"other\" 4}");
+		Expected<ParsedOptions> parsed = try_parse_json_config(json, desc);
+
+		ASSERT_THAT(parsed.has_value(), is(false));
+		ASSERT_THAT(parsed.error().kind == Parse_error::invalid_syntax, is(true));
+		ASSERT_THAT(parsed.error().token_index, is(22));
+
+		const char* bad[] = {"[1,]", "{\"a\" 1}", "01", "\"\\ud800\"", "{} {}", "[", "tru"};
+		for (const char* text : bad) {
+			istringstream in(text);
+			ASSERT_THAT(try_parse_json_config(in, desc).has_value(), is(false));
+		}
+
+		istringstream thrown_is("{\"level\": }");
+		bool thrown = false;
+		try {
+			parse_json_config(thrown_is, desc);
+		} catch (const Options_error& e) {
+			thrown = e.error.kind == Parse_error::invalid_syntax;
+		}
+		ASSERT_THAT(thrown, is(true));
+	}
+
+	TEST("included config files should be merged in declared order")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level", value<int>(), "set level")
+									("name", value<string>(), "set name")
+									("tags", value< vector<string> >()->composing(), "add tags");
+
+		config_dir dir;
+		dir.mkdir("conf.d");
+		dir.write("conf.d/20-b.json", "{\"tags\": \"b\", \"level\": 20}");
+		dir.write("conf.d/10-a.json", "{\"tags\": \"a\", \"include\": \"../extra.json\"}");
+		dir.write("conf.d/notes.txt", "not json");
+		dir.write("extra.json", "{\"tags\": \"extra\", \"name\": \"extra\"}");
+		string main = dir.write("main.json",
+			"{\"level\": 1, \"tags\": [\"main\"],\n"
+			" \"include\": [\"conf.d/*.json\"],\n"
+			" \"name\": \"main\"}");
+
+		file_observer observer;
+		ParseObserver* previous = set_parse_observer(&observer);
+		ParsedOptions parsed = parse_config_file(main, desc, 4);
+		set_parse_observer(previous);
+
+		VariablesMap vm;
+		store(parsed, vm);
+		ASSERT_THAT(any_cast<int>(vm["level"].value()), is(20));
+		ASSERT_THAT(any_cast<string>(vm["name"].value()), is(string("main")));
+		const vector<string>& tags = any_cast< vector<string> >(vm["tags"].value());
+		ASSERT_THAT(tags.size(), is(4u));
+		ASSERT_THAT(tags[0], is(string("main")));
+		ASSERT_THAT(tags[1], is(string("a")));
+		ASSERT_THAT(tags[2], is(string("extra")));
+		ASSERT_THAT(tags[3], is(string("b")));
+
+		ASSERT_THAT(observer.files.size(), is(4u));
+		ASSERT_THAT(observer.files[0], is(string("main.json")));
+		ASSERT_THAT(observer.files[1], is(string("10-a.json")));
+		ASSERT_THAT(observer.files[2], is(string("extra.json")));
+		ASSERT_THAT(observer.files[3], is(string("20-b.json")));
+	}
+
+	TEST("include cycles and unreadable files should be reported")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level", value<int>(), "set level");
+
+		config_dir dir;
+		string a = dir.write("a.json", "{\"include\": \"b.json\"}");
+		string b = dir.write("b.json", "{\"level\": 1, \"include\": [\"c.json\", \"a.json\"]}");
+		dir.write("c.json", "{\"level\": 2}");
+		string d = dir.write("d.json", "{\"include\": \"missing.json\"}");
+		string e = dir.write("e.json", "{\"include\": \"c.json\",\n \"level\" 3}");
+
+		Expected<ParsedOptions> cycle = try_parse_config_file(a, desc);
+		ASSERT_THAT(cycle.error().kind == Parse_error::include_cycle, is(true));
+		ASSERT_THAT(cycle.error().token, is(dir.path + "/a.json"));
+		ASSERT_THAT(cycle.error().file, is(b));
+
+		Expected<ParsedOptions> missing = try_parse_config_file(d, desc);
+		ASSERT_THAT(missing.error().kind == Parse_error::unreadable_file, is(true));
+		ASSERT_THAT(missing.error().token, is(dir.path + "/missing.json"));
+		ASSERT_THAT(missing.error().message(),
+		            is("cannot read config file '" + dir.path + "/missing.json' included from '" + d + "'"));
+
+		Expected<ParsedOptions> syntax = try_parse_config_file(e, desc);
+		ASSERT_THAT(syntax.error().kind == Parse_error::invalid_syntax, is(true));
+		ASSERT_THAT(syntax.error().file, is(e));
+
+		bool thrown = false;
+		try {
+			parse_config_file(dir.path + "/none.json", desc);
+		} catch (const Options_error& err) {
+			thrown = err.error.kind == Parse_error::unreadable_file;
+		}
+		ASSERT_THAT(thrown, is(true));
+	}
+};
@@ -2,6 +2,8 @@
 
 #include "../include/ProgramOptions.hpp"
 
+#include <thread>
+
 using namespace std;
 using namespace options;
 using namespace hamcrest;
@@ -122,6 +124,21 @@ FIXTURE(OptionTest)
 		ASSERT_THAT(varMap.has("filter"), is(false));
 	}
 
+	TEST("should store '--fil=1' under 'filter'")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+			        				("help,h", "produce help message")
+									("filter,f", "set filter");
+
+		const char* argv[] = {"","--fil=1"};
+		const int argc = 2;
+
+		VariablesMap varMap = parse_args(argc, argv, desc);
+		ASSERT_THAT(varMap.has("fil"), is(false));
+		ASSERT_THAT(varMap["filter"].value().str(), is(string("1")));
+	}
+
 	TEST("can parse '-hf=1' as 'filter' with value '1' and 'help'")
 	{
 		OptionsDescription desc("Allowed options");
@@ -139,4 +156,127 @@ FIXTURE(OptionTest)
 		ASSERT_THAT(varMap["filter"].value().str(), is(string("1")));
 	}
 
+	TEST("can find long and short names ignoring ASCII case")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("compression-level,c", "set compression level")
+									("filter,f", "set filter");
+
+		const OptionDescription* d = desc.find_nothrow("COMPRESSION-Level", false, true, true);
+		ASSERT_THAT(d != 0, is(true));
+		ASSERT_THAT(d->long_name(), is(string("compression-level")));
+
+		ASSERT_THAT(desc.find_nothrow("Compr", true, true, true) == d, is(true));
+		ASSERT_THAT(desc.find_nothrow("-C", false, true, true) == d, is(true));
+		ASSERT_THAT(desc.find_nothrow("-C", false, true, false) == 0, is(true));
+		ASSERT_THAT(desc.find_nothrow("COMPRESSION-LEVEL", false, false, false) == 0, is(true));
+		ASSERT_THAT(desc.find_nothrow("compression-levex", false, true, true) == 0, is(true));
+	}
+
+	TEST("name index should find options among many added out of order")
+	{
+		OptionsDescription desc("Allowed options");
+		vector<string> names;
+		for (unsigned i = 0; i < 300; ++i)
+			names.push_back("opt-" + to_string(i * 7 % 300));
+		for (const string& name : names)
+			desc.add_options()(name.c_str(), "");
+		desc.add_options()("Zeta,z", "")
+						  ("define-*", "");
+
+		for (const string& name : names)
+			ASSERT_THAT(desc.find_nothrow(name, false)->long_name(), is(name));
+		ASSERT_THAT(desc.find_nothrow("opt-299", true)->long_name(), is(string("opt-299")));
+		ASSERT_THAT(desc.find_nothrow("ZETA", false, true, false)->long_name(), is(string("Zeta")));
+		ASSERT_THAT(desc.find_nothrow("ze", true, true, false)->long_name(), is(string("Zeta")));
+		ASSERT_THAT(desc.find_nothrow("-Z", false, false, true)->long_name(), is(string("Zeta")));
+		ASSERT_THAT(desc.find_nothrow("define-x", false)->long_name(), is(string("define-*")));
+		ASSERT_THAT(desc.find_nothrow("opt-300", false) == 0, is(true));
+
+		// "opt-29" is itself an option, so it wins over "opt-290" and up.
+		ASSERT_THAT(desc.find_nothrow("opt-29", true)->long_name(), is(string("opt-29")));
+		Parse_error error;
+		ASSERT_THAT(desc.find_nothrow("opt-29", true, true, false, &error) != 0, is(true));
+		ASSERT_THAT(desc.find_nothrow("opt-", true, false, false, &error) == 0, is(true));
+		ASSERT_THAT(error.candidates.size(), is(300u));
+	}
+
+	TEST("options should outlive the description that registered them")
+	{
+		std::shared_ptr<OptionDescription> d;
+		OptionsDescription group("Group");
+		{
+			OptionsDescription desc("Allowed options");
+			desc.add_options()
+										("output-directory,o", value<string>(), "set output directory")
+										("output-format", "set output format");
+			group.add(desc);
+			d = desc.options()[0];
+		}
+
+		ASSERT_THAT(d->long_name(), is(string("output-directory")));
+		ASSERT_THAT(d->semantic()->max_tokens(), is(1u));
+		ASSERT_THAT(group.find_nothrow("output-format", false) != 0, is(true));
+		ASSERT_THAT(group.find_nothrow("output-f", true)->long_name(), is(string("output-format")));
+		ASSERT_THAT(group.find_nothrow("-o", false) == d.get(), is(true));
+	}
+
+	TEST("copies of a description should add options on their own threads")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()("level", value<int>(), "set level");
+		OptionsDescription copy(desc);
+
+		std::thread other([&copy] {
+			for (int i = 0; i < 200; ++i)
+				copy.add_options()(("copy-" + to_string(i)).c_str(), value<int>(), "");
+		});
+		for (int i = 0; i < 200; ++i)
+			desc.add_options()(("original-" + to_string(i)).c_str(), "");
+		other.join();
+
+		ASSERT_THAT(desc.options().size(), is(201u));
+		ASSERT_THAT(copy.options().size(), is(201u));
+		ASSERT_THAT(copy.options()[0] == desc.options()[0], is(true));
+		ASSERT_THAT(copy.find_nothrow("original-7", false) == 0, is(true));
+		ASSERT_THAT(copy.find_nothrow("copy-199", false)->semantic()->max_tokens(), is(1u));
+	}
+
+	TEST("parsed options should share one token buffer and convert back")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("help,h", "produce help message")
+									("filter,f", value<int>(), "set filter")
+									("include", value< vector<string> >()->multitoken(), "add include path");
+
+		const char* argv[] = {"", "-hf=1", "--include", "a", "b", "--bogus", "last"};
+		ParsedOptions parsed = command_line_parser(7, argv).options(desc).run();
+
+		ASSERT_THAT(parsed.size(), is(4u));
+		ASSERT_THAT(string(parsed.key(0)), is(string("help")));
+		ASSERT_THAT(string(parsed.key(3), parsed.key_length(3)), is(string("")));
+
+		vector<string> values;
+		parsed.values(2, values);
+		ASSERT_THAT(values.size(), is(2u));
+		ASSERT_THAT(values[1], is(string("b")));
+
+		Basic_option filter = parsed.option(1);
+		ASSERT_THAT(filter.string_key, is(string("filter")));
+		ASSERT_THAT(filter.value[0], is(string("1")));
+		ASSERT_THAT(filter.original_tokens.empty(), is(true));
+		ASSERT_THAT(filter.token_index, is(0));
+		ASSERT_THAT(parsed.option(0).original_tokens[0], is(string("-hf=1")));
+		ASSERT_THAT(parsed.option(3).position_key, is(0));
+
+		ParsedOptions copy(&desc);
+		for (const auto& opt : parsed.options())
+			copy.push_back(opt);
+		ASSERT_THAT(copy.tokens.size(), is(parsed.tokens.size()));
+		ASSERT_THAT(copy.option(2).original_tokens.size(), is(3u));
+		ASSERT_THAT(copy.option(2).token_index, is(1));
+	}
+
 };
@@ -0,0 +1,51 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(ParseCacheTest)
+{
+	TEST("identical command lines should share one map until the description changes")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level", value<int>(), "set level");
+
+		ParseCache cache(2);
+		const char* argv1[] = {"a", "--level=1"};
+		const char* argv2[] = {"b", "--level=2"};
+		const char* argv3[] = {"c", "--level=3"};
+
+		shared_ptr<const VariablesMap> first = cache.parse(2, argv1, desc);
+		ASSERT_THAT(cache.parse(2, argv1, desc) == first, is(true));
+		ASSERT_THAT(any_cast<int>((*first)["level"].value()), is(1));
+		ASSERT_THAT(cache.hits(), is(1ul));
+		ASSERT_THAT(cache.misses(), is(1ul));
+
+		cache.parse(2, argv2, desc);
+		cache.parse(2, argv1, desc);
+		cache.parse(2, argv3, desc);
+		ASSERT_THAT(cache.size(), is(2u));
+		ASSERT_THAT(cache.parse(2, argv1, desc) == first, is(true));
+		ASSERT_THAT(cache.misses(), is(3ul));
+
+		desc.add_options()
+									("levels", value<int>(), "set levels");
+		shared_ptr<const VariablesMap> changed = cache.parse(2, argv1, desc);
+		ASSERT_THAT(changed == first, is(false));
+		ASSERT_THAT(cache.misses(), is(4ul));
+
+		const char* ambiguous[] = {"a", "--lev=1"};
+		bool thrown = false;
+		try {
+			cache.parse(2, ambiguous, desc);
+		} catch (const Options_error&) {
+			thrown = true;
+		}
+		ASSERT_THAT(thrown, is(true));
+		ASSERT_THAT(cache.size(), is(2u));
+	}
+};
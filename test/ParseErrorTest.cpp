@@ -0,0 +1,68 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(ParseErrorTest)
+{
+	TEST("ambiguous abbreviation should be returned with its candidates")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("filter", value<string>(), "set filter")
+									("files", value<string>(), "set files");
+
+		ASSERT_THAT(desc.find_nothrow("fil", true) == 0, is(true));
+
+		const char* argv[] = {"", "x", "--fil=1"};
+		Expected<VariablesMap> vm = try_parse_args(3, argv, desc);
+
+		ASSERT_THAT(vm.has_value(), is(false));
+		ASSERT_THAT(vm.error().kind == Parse_error::ambiguous_option, is(true));
+		ASSERT_THAT(vm.error().token_index, is(1));
+		ASSERT_THAT(vm.error().token, is(string("fil")));
+		ASSERT_THAT(vm.error().candidates.size(), is(2u));
+		ASSERT_THAT(vm.error().candidates[0], is(string("filter")));
+		ASSERT_THAT(vm.error().candidates[1], is(string("files")));
+
+		bool thrown = false;
+		try {
+			parse_args(3, argv, desc);
+		} catch (const Options_error& e) {
+			thrown = e.error.kind == Parse_error::ambiguous_option;
+		}
+		ASSERT_THAT(thrown, is(true));
+	}
+
+	TEST("invalid value should be returned with its option and token")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("help,h", "produce help message")
+									("level", value<int>(), "set level")
+									("ids", value< vector<int> >()->composing(), "set ids");
+
+		const char* argv[] = {"", "-h", "--level=abc"};
+		Expected<VariablesMap> vm = try_parse_args(3, argv, desc);
+
+		ASSERT_THAT(vm.has_value(), is(false));
+		ASSERT_THAT(vm.error().kind == Parse_error::invalid_value, is(true));
+		ASSERT_THAT(vm.error().option, is(string("level")));
+		ASSERT_THAT(vm.error().token, is(string("abc")));
+		ASSERT_THAT(vm.error().token_index, is(1));
+
+		const char* argv2[] = {"", "--ids=1", "--ids=2", "--ids=x"};
+		vm = try_parse_args(4, argv2, desc);
+		ASSERT_THAT(vm.error().kind == Parse_error::invalid_value, is(true));
+		ASSERT_THAT(vm.error().token_index, is(2));
+
+		const char* argv3[] = {"", "--ids=1", "--ids=2", "--level=3"};
+		vm = try_parse_args(4, argv3, desc);
+		ASSERT_THAT(vm.has_value(), is(true));
+		ASSERT_THAT(any_cast< vector<int> >(vm.value()["ids"].value()).size(), is(2u));
+		ASSERT_THAT(any_cast<int>(vm.value()["level"].value()), is(3));
+	}
+};
@@ -0,0 +1,82 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+namespace {
+	struct recording_observer : ParseObserver
+	{
+		void token_classified(size_t index, const string& token,
+		                      token_kind kind, time_point)
+		{
+			events.push_back("token " + to_string(index) + " " + token +
+			                 " " + to_string(kind));
+		}
+
+		void option_matched(const string& name, const OptionDescription* d,
+		                    time_point)
+		{
+			events.push_back("match " + name + (d ? "" : " unregistered"));
+		}
+
+		void value_converted(const string& name, const Value_semantic&,
+		                     time_point start, time_point end)
+		{
+			events.push_back("convert " + name + (start <= end ? "" : " backwards"));
+		}
+
+		void default_applied(const string& name, time_point)
+		{
+			events.push_back("default " + name);
+		}
+
+		void notify_called(const string& name, const Value_semantic&,
+		                   time_point start, time_point end)
+		{
+			events.push_back("notify " + name + (start <= end ? "" : " backwards"));
+		}
+
+		vector<string> events;
+	};
+}
+
+FIXTURE(ParseObserverTest)
+{
+	TEST("observer should see every stage of a parse in order")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level,l", value<int>()->default_value(1), "set level")
+									("filter,f", value<string>(), "set filter");
+
+		recording_observer observer;
+		ParseObserver* previous = set_parse_observer(&observer);
+
+		const char* argv[] = {"", "--filter=x", "-q", "file"};
+		VariablesMap varMap = parse_args(4, argv, desc);
+		varMap.notify();
+
+		ASSERT_THAT(set_parse_observer(previous) == &observer, is(true));
+
+		const char* expected[] = {
+			"token 0 --filter=x 0",
+			"token 1 -q 1",
+			"token 2 file 2",
+			"match filter",
+			"match -q unregistered",
+			"convert filter",
+			"default level",
+			"notify filter",
+			"notify level",
+		};
+		ASSERT_THAT(observer.events ==
+		            vector<string>(expected, expected + sizeof(expected)/sizeof(*expected)),
+		            is(true));
+
+		parse_args(4, argv, desc);
+		ASSERT_THAT(observer.events.size(), is(sizeof(expected)/sizeof(*expected)));
+	}
+};
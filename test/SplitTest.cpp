@@ -0,0 +1,75 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(SplitTest)
+{
+	TEST("can split a command line at unquoted separators")
+	{
+		vector<string> tokens = split_unix("  --filter=1\t-h   'a b' x\"y z\"w \\ q ''  ");
+
+		ASSERT_THAT(tokens.size(), is(6u));
+		ASSERT_THAT(tokens[0], is(string("--filter=1")));
+		ASSERT_THAT(tokens[1], is(string("-h")));
+		ASSERT_THAT(tokens[2], is(string("a b")));
+		ASSERT_THAT(tokens[3], is(string("xy zw")));
+		ASSERT_THAT(tokens[4], is(string(" q")));
+		ASSERT_THAT(tokens[5], is(string("")));
+	}
+
+	TEST("should keep the other quote and escaped quotes inside quotes")
+	{
+		vector<string> tokens = split_unix("\"it's\" 'say \"hi\"' \"a\\\"b\" end\\");
+
+		ASSERT_THAT(tokens.size(), is(4u));
+		ASSERT_THAT(tokens[0], is(string("it's")));
+		ASSERT_THAT(tokens[1], is(string("say \"hi\"")));
+		ASSERT_THAT(tokens[2], is(string("a\"b")));
+		ASSERT_THAT(tokens[3], is(string("end\\")));
+	}
+
+	TEST("can split long lines with specials across block boundaries")
+	{
+		string line;
+		vector<string> expected;
+		for (unsigned i = 0; i < 200; ++i)
+		{
+			string word = "w" + to_string(i * 7919 % 1000);
+			if (i % 3 == 0)
+			{
+				line += "'" + word + " q' ";
+				expected.push_back(word + " q");
+			}
+			else
+			{
+				line += word + string(i % 5 + 1, ' ');
+				expected.push_back(word);
+			}
+		}
+
+		vector<string> tokens = split_unix(line);
+		ASSERT_THAT(tokens == expected, is(true));
+	}
+
+	TEST("can parse the tokens of a split command line")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("help,h", "produce help message")
+									("filter,f", "set filter");
+
+		TokenBuffer tokens;
+		split_unix("-h --filter='a b'", tokens);
+		ASSERT_THAT(tokens.size(), is(2u));
+
+		VariablesMap varMap;
+		store(command_line_parser(std::move(tokens)).options(desc).run(), varMap);
+
+		ASSERT_THAT(varMap.has("help"), is(true));
+		ASSERT_THAT(varMap["filter"].value().str(), is(string("a b")));
+	}
+};
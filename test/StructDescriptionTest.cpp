@@ -0,0 +1,90 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+namespace {
+	struct Config
+	{
+		int level;
+		string filter;
+		bool verbose;
+		vector<int> ids;
+	};
+
+	Struct_description<Config> config_description()
+	{
+		Struct_description<Config> d("Config");
+		d.field<OPTIONS_FIELD(Config, level)>("level,l", "set level", 3)
+		 .field<OPTIONS_FIELD(Config, filter)>("filter,f", "set filter")
+		 .field<OPTIONS_FIELD(Config, verbose)>("verbose,v", "be verbose")
+		 .field<OPTIONS_FIELD(Config, ids)>("ids", "add ids");
+		return d;
+	}
+}
+
+FIXTURE(StructDescriptionTest)
+{
+	TEST("can fill a struct from its field descriptions")
+	{
+		const char* argv[] = {"", "-v", "--filter=x", "--ids=1", "--ids=2", "file"};
+		Config config = config_description().parse(6, argv);
+
+		ASSERT_THAT(config.level, is(3));
+		ASSERT_THAT(config.filter, is(string("x")));
+		ASSERT_THAT(config.verbose, is(true));
+		ASSERT_THAT(config.ids.size(), is(2u));
+		ASSERT_THAT(config.ids[1], is(2));
+	}
+
+	TEST("bound description should have one option per field and no map entries")
+	{
+		Config config = Config();
+		OptionsDescription desc = config_description().bind(config);
+		ASSERT_THAT(desc.options().size(), is(4u));
+
+		const char* argv[] = {"", "-l=7"};
+		VariablesMap vm;
+		store(command_line_parser(2, argv).options(desc).run(), vm);
+
+		ASSERT_THAT(vm.size(), is(0u));
+		ASSERT_THAT(config.level, is(7));
+		ASSERT_THAT(config.verbose, is(false));
+	}
+
+	TEST("try_parse should report an invalid field value")
+	{
+		const char* argv[] = {"", "--level=high"};
+		Expected<Config> config = config_description().try_parse(2, argv);
+
+		ASSERT_THAT(config.has_value(), is(false));
+		ASSERT_THAT(config.error().option, is(string("level")));
+	}
+
+	TEST("parse should check the rules declared between fields")
+	{
+		Struct_description<Config> d = config_description();
+		d.conflicts({"verbose", "filter"})
+		 .depends("ids", {"filter"});
+
+		const char* both[] = {"", "-v", "--filter=x"};
+		Expected<Config> config = d.try_parse(3, both);
+		ASSERT_THAT(config.has_value(), is(false));
+		ASSERT_THAT(config.error().kind == Parse_error::conflicting_options, is(true));
+
+		bool thrown = false;
+		const char* alone[] = {"", "--ids=1"};
+		try {
+			d.parse(2, alone);
+		} catch (const Options_error& e) {
+			thrown = e.error.kind == Parse_error::missing_dependency;
+		}
+		ASSERT_THAT(thrown, is(true));
+
+		const char* fine[] = {"", "--filter=x", "--ids=1"};
+		ASSERT_THAT(d.parse(3, fine).ids.size(), is(1u));
+	}
+};
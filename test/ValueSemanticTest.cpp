@@ -0,0 +1,227 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(ValueSemanticTest)
+{
+	TEST("can convert typed value '--level=5' to int")
+	{
+		OptionsDescription desc;
+		desc.add_options()("level", value<int>(), "set level");
+
+		const char* argv[] = {"", "--level=5"};
+		VariablesMap varMap = parse_args(2, argv, desc);
+
+		ASSERT_THAT(any_cast<int>(varMap["level"].value()), is(5));
+	}
+
+	TEST("multitoken option should collect all following tokens into a vector")
+	{
+		OptionsDescription desc;
+		desc.add_options()("ids", value< vector<int> >()->multitoken(), "ids");
+
+		const char* argv[] = {"", "--ids", "1", "2", "3"};
+		VariablesMap varMap = parse_args(5, argv, desc);
+
+		const vector<int>& ids = any_cast< vector<int> >(varMap["ids"].value());
+		ASSERT_THAT(ids.size(), is(3u));
+		ASSERT_THAT(ids[2], is(3));
+	}
+
+	TEST("composing option should accumulate values of repeated occurrences")
+	{
+		OptionsDescription desc;
+		desc.add_options()("ids", value< vector<int> >()->multitoken()->composing(), "ids")
+						("names", value< vector<string> >()->multitoken(), "names");
+
+		const char* argv[] = {"", "--ids=1", "--names=a", "--ids", "2", "3", "--names=b"};
+		VariablesMap varMap = parse_args(7, argv, desc);
+
+		const vector<int>& ids = any_cast< vector<int> >(varMap["ids"].value());
+		ASSERT_THAT(ids.size(), is(3u));
+		ASSERT_THAT(ids[0], is(1));
+		ASSERT_THAT(ids[2], is(3));
+
+		const vector<string>& names = any_cast< vector<string> >(varMap["names"].value());
+		ASSERT_THAT(names.size(), is(1u));
+		ASSERT_THAT(names[0], is(string("b")));
+	}
+
+	TEST("multitoken option should take tens of thousands of tokens")
+	{
+		OptionsDescription desc;
+		desc.add_options()("ids", value< vector<long> >()->multitoken(), "ids");
+
+		vector<string> args(1, "--ids");
+		for (int i = 0; i < 40000; ++i)
+			args.push_back(to_string(i));
+
+		VariablesMap varMap;
+		store(Basic_command_line_parser(args).options(desc).run(), varMap);
+
+		const vector<long>& ids = any_cast< vector<long> >(varMap["ids"].value());
+		ASSERT_THAT(ids.size(), is(40000u));
+		ASSERT_THAT(ids.back(), is(39999L));
+	}
+
+	TEST("invalid element should leave the vector untouched")
+	{
+		OptionsDescription desc;
+		desc.add_options()("ids", value< vector<int> >()->multitoken(), "ids");
+
+		const char* argv[] = {"", "--ids", "1", "x"};
+		VariablesMap varMap = parse_args(4, argv, desc);
+
+		ASSERT_THAT(varMap["ids"].empty(), is(true));
+	}
+
+	TEST("notify should write the value into the bound variable")
+	{
+		int level = 0;
+		OptionsDescription desc;
+		desc.add_options()("level", value<int>(&level), "set level");
+
+		const char* argv[] = {"", "--level=7"};
+		VariablesMap varMap = parse_args(2, argv, desc);
+		varMap.notify();
+
+		ASSERT_THAT(level, is(7));
+	}
+
+	TEST("delimited option should split one token into a vector of integers")
+	{
+		OptionsDescription desc;
+		desc.add_options()("ids", value< vector<int> >()->delimiter(','), "ids")
+						("names", value< vector<string> >()->delimiter(':'), "names");
+
+		const char* argv[] = {"", "--ids=1,-5,+9", "--names=a:bc:"};
+		VariablesMap varMap = parse_args(3, argv, desc);
+
+		const vector<int>& ids = any_cast< vector<int> >(varMap["ids"].value());
+		ASSERT_THAT(ids.size(), is(3u));
+		ASSERT_THAT(ids[1], is(-5));
+		ASSERT_THAT(ids[2], is(9));
+
+		const vector<string>& names = any_cast< vector<string> >(varMap["names"].value());
+		ASSERT_THAT(names.size(), is(3u));
+		ASSERT_THAT(names[1], is(string("bc")));
+		ASSERT_THAT(names[2], is(string("")));
+	}
+
+	TEST("delimited integers should match strtoll across block boundaries")
+	{
+		OptionsDescription desc;
+		desc.add_options()("ids", value< vector<long long> >()->delimiter(','), "ids");
+
+		string list("--ids=");
+		vector<long long> expected;
+		unsigned long long x = 1;
+		for (int i = 0; i < 1000; ++i)
+		{
+			x = x * 7 + i;
+			long long v = (i % 3 == 0) ?
+					-static_cast<long long>(x % 1000000000000000000ULL) :
+					static_cast<long long>(x % (1ULL << (i % 63)));
+			expected.push_back(v);
+			list += (i ? "," : "") + to_string(v);
+		}
+		list += ",9223372036854775807,-9223372036854775808";
+		expected.push_back(9223372036854775807LL);
+		expected.push_back(-9223372036854775807LL - 1);
+
+		const char* argv[] = {"", list.c_str()};
+		VariablesMap varMap = parse_args(2, argv, desc);
+
+		ASSERT_THAT(any_cast< vector<long long> >(varMap["ids"].value()) == expected, is(true));
+	}
+
+	TEST("malformed or out of range delimited integers should be rejected")
+	{
+		OptionsDescription desc;
+		desc.add_options()("a", value< vector<int> >()->delimiter(','), "a")
+						("b", value< vector<int> >()->delimiter(','), "b")
+						("c", value< vector<unsigned char> >()->delimiter(','), "c")
+						("d", value< vector<unsigned> >()->delimiter(','), "d")
+						("e", value< vector<int> >()->delimiter(','), "e");
+
+		const char* argv[] = {"", "--a=1,,2", "--b=1,2x", "--c=255,256", "--d=-1", "--e=1,2,"};
+		VariablesMap varMap = parse_args(6, argv, desc);
+
+		ASSERT_THAT(varMap["a"].empty(), is(true));
+		ASSERT_THAT(varMap["b"].empty(), is(true));
+		ASSERT_THAT(varMap["c"].empty(), is(true));
+		ASSERT_THAT(varMap["d"].empty(), is(true));
+		ASSERT_THAT(varMap["e"].empty(), is(true));
+	}
+
+	TEST("bind only options should be written to their variables without map entries")
+	{
+		int level = 0;
+		string name = "unset";
+		vector<int> ids;
+		vector<int> list(1, 99);
+
+		OptionsDescription desc;
+		desc.add_options()("level", value<int>(&level)->bind_only(), "set level")
+						("name", value<string>(&name)->default_value("anonymous")->bind_only(), "set name")
+						("ids", value< vector<int> >(&ids)->composing()->bind_only(), "set ids")
+						("list", value< vector<int> >(&list)->delimiter(',')->default_value(vector<int>(1, 7))->bind_only(), "set list");
+
+		const char* first[] = {"", "--level=5", "--ids=1", "--ids=2"};
+		const char* second[] = {"", "--level=6", "--ids=3", "--name=bob", "--list=4,5"};
+		const char* invalid[] = {"", "--ids=x"};
+
+		VariablesMap vm;
+		store(Basic_command_line_parser(4, first).options(desc).run(), vm);
+		ASSERT_THAT(vm.size(), is(0u));
+		ASSERT_THAT(level, is(5));
+		ASSERT_THAT(name, is(string("anonymous")));
+		ASSERT_THAT(ids.size(), is(2u));
+		ASSERT_THAT(list.size(), is(1u));
+		ASSERT_THAT(list[0], is(7));
+
+		store(Basic_command_line_parser(5, second).options(desc).run(), vm);
+		store(Basic_command_line_parser(2, invalid).options(desc).run(), vm);
+		ASSERT_THAT(vm.size(), is(0u));
+		ASSERT_THAT(level, is(5));
+		ASSERT_THAT(name, is(string("bob")));
+		ASSERT_THAT(ids.size(), is(3u));
+		ASSERT_THAT(ids[2], is(3));
+		ASSERT_THAT(list.size(), is(2u));
+		ASSERT_THAT(list[1], is(5));
+
+		ASSERT_THAT(try_store(Basic_command_line_parser(2, invalid).options(desc).run(), vm)
+		            .error().kind == Parse_error::invalid_value, is(true));
+		ASSERT_THAT(ids.size(), is(3u));
+	}
+
+	TEST("built-in types should skip the virtual parse chain and others keep it")
+	{
+		OptionsDescription desc("Allowed options");
+		desc.add_options()
+									("level", value<int>(), "set level")
+									("ids", value< vector<int> >()->delimiter(','), "set ids")
+									("flag", value<bool>()->implicit_value(true), "set flag")
+									("wide", wvalue<int>(), "set wide");
+
+		ASSERT_THAT(desc.find("level", false)->builtin_kind(), is(int(detail::int_kind)));
+		ASSERT_THAT(desc.find("ids", false)->builtin_kind(), is(int(detail::custom_kind)));
+		ASSERT_THAT(desc.find("wide", false)->builtin_kind(), is(int(detail::custom_kind)));
+
+		const char* argv[] = {"", "--level=7", "--ids=1,2", "--flag", "--wide=3"};
+		VariablesMap vm = parse_args(5, argv, desc);
+		ASSERT_THAT(any_cast<int>(vm["level"].value()), is(7));
+		ASSERT_THAT(any_cast< vector<int> >(vm["ids"].value()).size(), is(2u));
+		ASSERT_THAT(any_cast<bool>(vm["flag"].value()), is(true));
+		ASSERT_THAT(any_cast<int>(vm["wide"].value()), is(3));
+
+		const char* bad[] = {"", "--level=7x"};
+		Expected<VariablesMap> checked = try_parse_args(2, bad, desc);
+		ASSERT_THAT(checked.error().kind == Parse_error::invalid_value, is(true));
+	}
+
+};
@@ -0,0 +1,348 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(VariablesMapTest)
+{
+	OptionsDescription desc;
+
+	SETUP()
+	{
+		desc.add_options()("filter", "set filter")
+						("date", "set date")
+						("level", "set level");
+	}
+
+	TEST("flattened chain should resolve each name like the chain itself")
+	{
+		const char* cmdline[] = {"", "--filter=1"};
+		const char* config[] = {"", "--filter=2", "--date=today"};
+
+		VariablesMap base = parse_args(3, config, desc);
+		VariablesMap top = parse_args(2, cmdline, desc);
+		top.next(&base);
+
+		FlatVariablesMap flat = top.flatten();
+
+		ASSERT_THAT(flat.size(), is(2u));
+		ASSERT_THAT(flat["filter"].value().str(), is(string("1")));
+		ASSERT_THAT(flat["date"].value().str(), is(string("today")));
+		ASSERT_THAT(flat.has("level"), is(false));
+	}
+
+	TEST("flattened chain should stay frozen until refreshed")
+	{
+		const char* cmdline[] = {"", "--filter=1"};
+		const char* config[] = {"", "--date=today"};
+
+		VariablesMap base = parse_args(2, config, desc);
+		VariablesMap top = parse_args(2, cmdline, desc);
+		top.next(&base);
+
+		FlatVariablesMap flat = top.flatten();
+		ASSERT_THAT(flat.stale(), is(false));
+
+		const char* more[] = {"", "--level=3"};
+		store(Basic_command_line_parser(2, more).options(desc).run(), base);
+
+		ASSERT_THAT(flat.stale(), is(true));
+		ASSERT_THAT(flat.has("level"), is(false));
+		flat.refresh();
+		ASSERT_THAT(flat["level"].value().str(), is(string("3")));
+		ASSERT_THAT(flat.stale(), is(false));
+
+		top.next(0);
+		ASSERT_THAT(flat.has("date"), is(true));
+		flat.refresh();
+		ASSERT_THAT(flat.has("date"), is(false));
+	}
+
+	TEST("overlay should return overrides and fall back to the shared base")
+	{
+		const char* config[] = {"", "--filter=2", "--date=today"};
+		std::shared_ptr<const VariablesMap> base(
+				new VariablesMap(parse_args(3, config, desc)));
+
+		VariablesOverlay tenant(base);
+		tenant.set("filter", Any(string("7")));
+
+		ASSERT_THAT(tenant.override_count(), is(1u));
+		ASSERT_THAT(tenant["filter"].value().str(), is(string("7")));
+		ASSERT_THAT(tenant["date"].value().str(), is(string("today")));
+		ASSERT_THAT((*base)["filter"].value().str(), is(string("2")));
+		ASSERT_THAT(tenant.has("level"), is(false));
+
+		ASSERT_THAT(tenant.erase("filter"), is(true));
+		ASSERT_THAT(tenant["filter"].value().str(), is(string("2")));
+	}
+
+	TEST("overlay should keep the last of duplicated overrides")
+	{
+		const char* config[] = {"", "--filter=2"};
+		std::shared_ptr<const VariablesMap> base(
+				new VariablesMap(parse_args(2, config, desc)));
+
+		vector<VariablesOverlay::override_type> overrides;
+		overrides.push_back(make_pair(string("level"), VariableValue(Any(string("1")), false)));
+		overrides.push_back(make_pair(string("date"), VariableValue(Any(string("now")), false)));
+		overrides.push_back(make_pair(string("level"), VariableValue(Any(string("9")), false)));
+
+		VariablesOverlay tenant(base, overrides);
+
+		ASSERT_THAT(tenant.override_count(), is(2u));
+		ASSERT_THAT(tenant["level"].value().str(), is(string("9")));
+		ASSERT_THAT(tenant.flatten()["filter"].value().str(), is(string("2")));
+	}
+
+	TEST("publisher should keep a retired snapshot until its reader leaves")
+	{
+		const char* first[] = {"", "--filter=1"};
+		const char* second[] = {"", "--filter=2"};
+
+		VariablesMapPublisher publisher(4);
+		publisher.publish(parse_args(2, first, desc));
+
+		VariablesMapPublisher::Subscriber reader = publisher.subscribe();
+		{
+			VariablesMapPublisher::Snapshot old = reader.read();
+			publisher.publish(parse_args(2, second, desc));
+
+			ASSERT_THAT((*old)["filter"].value().str(), is(string("1")));
+			ASSERT_THAT(publisher.reclaim(), is(1u));
+		}
+		ASSERT_THAT(publisher.reclaim(), is(0u));
+		ASSERT_THAT((*reader.read())["filter"].value().str(), is(string("2")));
+	}
+
+	TEST("publisher snapshots should survive their subscriber being moved")
+	{
+		const char* first[] = {"", "--filter=1"};
+		const char* second[] = {"", "--filter=2"};
+
+		VariablesMapPublisher publisher(4);
+		publisher.publish(parse_args(2, first, desc));
+
+		vector<VariablesMapPublisher::Subscriber> readers;
+		readers.push_back(publisher.subscribe());
+		{
+			VariablesMapPublisher::Snapshot old = readers[0].read();
+			// Reallocating moves the first subscriber.
+			readers.push_back(publisher.subscribe());
+			readers.push_back(publisher.subscribe());
+			publisher.publish(parse_args(2, second, desc));
+
+			ASSERT_THAT((*old)["filter"].value().str(), is(string("1")));
+			ASSERT_THAT(publisher.reclaim(), is(1u));
+		}
+		ASSERT_THAT(publisher.reclaim(), is(0u));
+		ASSERT_THAT((*readers[0].read())["filter"].value().str(), is(string("2")));
+	}
+
+	TEST("first store should win and notify should wait for required options")
+	{
+		int level = 0;
+		OptionsDescription options;
+		options.add_options()("level", value<int>(&level)->required(), "set level")
+							("tag", value<string>()->default_value("none"), "set tag");
+
+		const char* none[] = {""};
+		const char* first[] = {"", "--level=1"};
+		const char* second[] = {"", "--level=2"};
+
+		VariablesMap vm;
+		store(Basic_command_line_parser(1, none).options(options).run(), vm);
+		vm.notify();
+		ASSERT_THAT(level, is(0));
+		ASSERT_THAT(vm["tag"].value().str(), is(string("none")));
+
+		store(Basic_command_line_parser(2, first).options(options).run(), vm);
+		store(Basic_command_line_parser(2, second).options(options).run(), vm);
+		vm.notify();
+		ASSERT_THAT(level, is(1));
+
+		vm.clear();
+		store(Basic_command_line_parser(2, second).options(options).run(), vm);
+		vm.notify();
+		ASSERT_THAT(level, is(2));
+	}
+
+	TEST("parallel store should leave the map as a plain store does")
+	{
+		OptionsDescription options;
+		options.add_options()("ids", value< vector<int> >()->multitoken()->composing(), "add ids")
+							("level", value<int>(), "set level")
+							("name", value<string>()->default_value("none"), "set name")
+							("tag", value< vector<string> >()->composing(), "add tag");
+
+		vector<string> args;
+		args.push_back("--level=1");
+		args.push_back("--ids");
+		for (int i = 0; i < 10000; ++i)
+			args.push_back(to_string(i));
+		args.push_back("--tag=a");
+		args.push_back("--level=2");
+		args.push_back("--ids");
+		args.push_back("42");
+		args.push_back("--tag=b");
+		ParsedOptions parsed = command_line_parser(args).options(options).run();
+
+		VariablesMap plain, parallel;
+		store(parsed, plain);
+		store_parallel(parsed, parallel, 4);
+
+		ASSERT_THAT(parallel.size(), is(plain.size()));
+		ASSERT_THAT(any_cast<int>(parallel["level"].value()), is(2));
+		ASSERT_THAT(any_cast<string>(parallel["name"].value()), is(string("none")));
+		ASSERT_THAT(any_cast< vector<int> >(parallel["ids"].value()) == any_cast< vector<int> >(plain["ids"].value()), is(true));
+		ASSERT_THAT(any_cast< vector<int> >(parallel["ids"].value()).size(), is(10001u));
+		ASSERT_THAT(any_cast< vector<string> >(parallel["tag"].value()).size(), is(2u));
+
+		// The first non-composing occurrence across stores still wins.
+		const char* again[] = {"", "--level=3", "--tag=c"};
+		store_parallel(command_line_parser(3, again).options(options).run(), parallel, 4);
+		ASSERT_THAT(any_cast<int>(parallel["level"].value()), is(2));
+		ASSERT_THAT(any_cast< vector<string> >(parallel["tag"].value()).size(), is(3u));
+	}
+
+	TEST("parallel store should report the first invalid value and store nothing")
+	{
+		OptionsDescription options;
+		options.add_options()("ids", value< vector<int> >()->multitoken(), "add ids")
+							("level", value<int>(), "set level");
+
+		vector<string> args;
+		args.push_back("--level=x");
+		args.push_back("--ids");
+		for (int i = 0; i < 10000; ++i)
+			args.push_back(i == 7000 ? "y" : to_string(i));
+		ParsedOptions parsed = command_line_parser(args).options(options).run();
+
+		VariablesMap vm;
+		Expected<void> stored = try_store_parallel(parsed, vm, 4);
+		ASSERT_THAT(stored.error().kind == Parse_error::invalid_value, is(true));
+		ASSERT_THAT(stored.error().option, is(string("level")));
+		ASSERT_THAT(vm.empty(), is(true));
+
+		store_parallel(parsed, vm, 4);
+		ASSERT_THAT(vm["ids"].empty(), is(true));
+		ASSERT_THAT(vm["level"].empty(), is(true));
+	}
+
+	TEST("merged sources should keep precedence and record where values came from")
+	{
+		OptionsDescription options;
+		options.add_options()("level", value<int>()->default_value(1), "set level")
+							("name", value<string>(), "set name")
+							("tags", value< vector<string> >()->composing(), "add tags")
+							("mode", value<string>()->default_value("fast"), "set mode");
+
+		const char* argv[] = {"", "x", "--tags=cmd", "--level=3"};
+		ParsedOptions cmdline = command_line_parser(4, argv).options(options).run();
+
+		setenv("VMTEST_LEVEL", "4", 1);
+		setenv("VMTEST_NAME", "env", 1);
+		setenv("VMTEST_OTHER", "ignored", 1);
+		ParsedOptions env = parse_environment(options, "VMTEST_");
+		unsetenv("VMTEST_LEVEL");
+		unsetenv("VMTEST_NAME");
+		unsetenv("VMTEST_OTHER");
+		ASSERT_THAT(env.size(), is(2u));
+
+		istringstream json("{\"name\": \"file\", \"tags\": [\"file\"]}");
+		ParsedOptions file = parse_json_config(json, options);
+
+		VariablesMap vm;
+		store_sources({&cmdline, &env, &file}, vm);
+
+		ASSERT_THAT(any_cast<int>(vm["level"].value()), is(3));
+		ASSERT_THAT(vm["level"].source(), is(0u));
+		ASSERT_THAT(vm["level"].position(), is(2));
+		ASSERT_THAT(any_cast<string>(vm["name"].value()), is(string("env")));
+		ASSERT_THAT(vm["name"].source(), is(1u));
+		ASSERT_THAT(any_cast< vector<string> >(vm["tags"].value()).size(), is(2u));
+		ASSERT_THAT(vm["tags"].source(), is(2u));
+		ASSERT_THAT(vm["tags"].position(), is(1));
+		ASSERT_THAT(vm["mode"].isDefaulted(), is(true));
+		ASSERT_THAT(vm["mode"].source(), is(3u));
+		ASSERT_THAT(vm["mode"].position(), is(-1));
+
+		VariablesMap chained;
+		store(cmdline, chained);
+		store(env, chained);
+		store(file, chained);
+		ASSERT_THAT(chained.size(), is(vm.size()));
+		ASSERT_THAT(any_cast<string>(chained["name"].value()), is(string("env")));
+
+		// Provenance lives in what was padding.
+		ASSERT_THAT(sizeof(VariableValue) <=
+		            sizeof(Any) + sizeof(void*) + sizeof(std::shared_ptr<const Value_semantic>)
+		            + sizeof(std::shared_ptr<const detail::Default_value>), is(true));
+	}
+
+	TEST("defaults should be shared between maps and lazy ones computed when first read")
+	{
+		int calls = 0;
+		int jobs = 0;
+		OptionsDescription options;
+		options.add_options()("mode", value<string>()->default_value("fast"), "set mode")
+							("threads", value<int>()->lazy_default_value(
+								[&calls] { ++calls; return 8; }, "cores"), "set threads")
+							("jobs", value<int>(&jobs)->lazy_default_value(
+								[] { return 2; }, "2"), "set jobs");
+		ASSERT_THAT(options.defaults() == options.defaults(), is(true));
+
+		const char* argv[] = {""};
+		VariablesMap first = parse_args(1, argv, options);
+		VariablesMap second = parse_args(1, argv, options);
+		notify(first);
+		notify(second);
+		ASSERT_THAT(jobs, is(2));
+		ASSERT_THAT(calls, is(0));
+		ASSERT_THAT(first["threads"].isDefaulted(), is(true));
+		ASSERT_THAT(&first["mode"].value() == &second["mode"].value(), is(true));
+
+		ASSERT_THAT(any_cast<int>(first["threads"].value()), is(8));
+		ASSERT_THAT(any_cast<int>(second["threads"].value()), is(8));
+		ASSERT_THAT(calls, is(1));
+
+		any_cast<string>(first.at("mode").value()) = "slow";
+		ASSERT_THAT(any_cast<string>(first["mode"].value()), is(string("slow")));
+		ASSERT_THAT(any_cast<string>(second["mode"].value()), is(string("fast")));
+
+		ostringstream help;
+		help << options;
+		ASSERT_THAT(help.str().find("(=cores)") != string::npos, is(true));
+	}
+
+	TEST("wildcard keys should be tracked by the map and not interned for the process")
+	{
+		OptionsDescription options;
+		options.add_options()("define-*", value<string>(), "define a macro");
+
+		vector<string> args = {"--define-a=1", "--define-a=2"};
+		VariablesMap vm;
+		store(command_line_parser(args).options(options).run(), vm);
+		args = {"--define-a=3", "--define-b=4"};
+		store(command_line_parser(args).options(options).run(), vm);
+		ASSERT_THAT(any_cast<string>(vm["define-a"].value()), is(string("2")));
+		ASSERT_THAT(any_cast<string>(vm["define-b"].value()), is(string("4")));
+
+		const unsigned before = detail::name_id("wildcard test probe before");
+		for (int i = 0; i < 10000; ++i)
+		{
+			vm.clear();
+			args = {"--define-" + to_string(i) + "=x"};
+			store(command_line_parser(args).options(options).run(), vm);
+		}
+		ASSERT_THAT(vm.m_wildcard_ids.size(), is(1u));
+		ASSERT_THAT(detail::name_id("wildcard test probe after"), is(before + 1));
+	}
+
+};
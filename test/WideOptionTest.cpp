@@ -0,0 +1,54 @@
+#include "magellan/magellan.hpp"
+
+#include "../include/ProgramOptions.hpp"
+#include "../include/program_options/detail/Utf8.hpp"
+
+using namespace std;
+using namespace options;
+using namespace hamcrest;
+
+FIXTURE(WideOptionTest)
+{
+	TEST("can parse wide arguments into wide and narrow values")
+	{
+		OptionsDescription desc;
+		desc.add_options()("path", wvalue<wstring>(), "path")
+						("name", value<string>(), "name")
+						("level", wvalue<int>(), "level");
+
+		const wchar_t* argv[] = {L"", L"--path=/tmp/déjà/文件", L"--name=café", L"--level=3"};
+		VariablesMap varMap = parse_args(4, argv, desc);
+
+		ASSERT_THAT(any_cast<wstring>(varMap["path"].value()) == L"/tmp/déjà/文件", is(true));
+		ASSERT_THAT(any_cast<string>(varMap["name"].value()), is(string("caf\xc3\xa9")));
+		ASSERT_THAT(any_cast<int>(varMap["level"].value()), is(3));
+	}
+
+	TEST("wide multitoken and delimited values should be converted per token")
+	{
+		OptionsDescription desc;
+		desc.add_options()("files", wvalue< vector<wstring> >()->multitoken(), "files")
+						("ids", wvalue< vector<int> >()->delimiter(L','), "ids");
+
+		const char* argv[] = {"", "--files", "a\xc3\xa4", "b", "--ids=4,5"};
+		VariablesMap varMap = parse_args(5, argv, desc);
+
+		const vector<wstring>& files = any_cast< vector<wstring> >(varMap["files"].value());
+		ASSERT_THAT(files.size(), is(2u));
+		ASSERT_THAT(files[0] == L"aä", is(true));
+		ASSERT_THAT(any_cast< vector<int> >(varMap["ids"].value()).size(), is(2u));
+	}
+
+	TEST("utf8 conversion should round trip and replace malformed input")
+	{
+		string text("plain ascii prefix longer than sixteen bytes \xe2\x82\xac \xf0\x9f\x98\x80 end");
+		ASSERT_THAT(detail::to_utf8(detail::from_utf8(text)), is(text));
+		ASSERT_THAT(detail::is_ascii(text.data(), 44), is(true));
+		ASSERT_THAT(detail::is_ascii(text.data(), text.size()), is(false));
+
+		ASSERT_THAT(detail::from_utf8("a\xff" "b") == L"a�b", is(true));
+		ASSERT_THAT(detail::from_utf8("\xed\xa0\x80") == L"���", is(true));
+		ASSERT_THAT(detail::from_utf8("\xe2\x82") == L"��", is(true));
+	}
+
+};